@@ -0,0 +1,229 @@
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+use IEEE.math_real.all;
+
+-- Direct-mapped write-through cache between the arbiter and the SDRAM
+-- controller. A read miss fetches the whole line with pipelined Wishbone
+-- reads, which the controller serves from a single open row, while writes
+-- are passed through and update the line only if it is already cached.
+-- Read hits are acknowledged in the cycle after the strobe, as BRAM does.
+
+entity WB_SDRAM_Cache is
+	generic (
+		g_LINES : positive := 256;			-- 4KiB with 16 byte lines
+		g_LINE_WORDS : positive := 4
+	);
+	port (
+		clk : in std_logic;
+		rst_n : in std_logic;
+		-- Arbiter
+		i_wb_cyc : in std_logic;
+		i_wb_stb : in std_logic;
+		i_wb_we : in std_logic;
+		i_wb_addr : in std_logic_vector(21 downto 0);
+		i_wb_data : in std_logic_vector(31 downto 0);
+		i_wb_sel : in std_logic_vector(3 downto 0);
+		o_wb_stall : out std_logic;
+		o_wb_ack : out std_logic;
+		o_wb_data : out std_logic_vector(31 downto 0);
+		-- SDRAM controller
+		o_wb_sdram_cyc : out std_logic;
+		o_wb_sdram_stb : out std_logic;
+		o_wb_sdram_we : out std_logic;
+		o_wb_sdram_addr : out std_logic_vector(21 downto 0);
+		o_wb_sdram_data : out std_logic_vector(31 downto 0);
+		o_wb_sdram_sel : out std_logic_vector(3 downto 0);
+		i_wb_sdram_stall : in std_logic;
+		i_wb_sdram_ack : in std_logic;
+		i_wb_sdram_data : in std_logic_vector(31 downto 0);
+		-- Read hit and miss counters
+		o_hits : out std_logic_vector(31 downto 0);
+		o_misses : out std_logic_vector(31 downto 0)
+	);
+end WB_SDRAM_Cache;
+
+architecture Behavioral of WB_SDRAM_Cache is
+
+	constant c_offset_len : natural := natural(ceil(log2(real(g_LINE_WORDS))));
+	constant c_index_len : natural := natural(ceil(log2(real(g_LINES))));
+	constant c_index_low : natural := 2 + c_offset_len;
+	constant c_tag_low : natural := c_index_low + c_index_len;
+	constant c_tag_len : natural := 22 - c_tag_low;
+
+	type t_state is (INIT, IDLE, LOOKUP, FILL, RESPOND, WRITE);
+	signal s_state : t_state;
+
+	-- Byte lanes are separate memories, so that writes can be partial
+	type t_lane is array(0 to g_LINES * g_LINE_WORDS - 1) of std_logic_vector(7 downto 0);
+	-- Tag with the valid flag in the top bit
+	type t_tags is array(0 to g_LINES - 1) of std_logic_vector(c_tag_len downto 0);
+	signal s_tags : t_tags;
+
+	signal s_index : unsigned(c_index_len - 1 downto 0);
+	signal s_offset : unsigned(c_offset_len - 1 downto 0);
+	signal s_tag : std_logic_vector(c_tag_len - 1 downto 0);
+
+	signal s_data_raddr : unsigned(c_index_len + c_offset_len - 1 downto 0);
+	signal s_data_waddr : unsigned(c_index_len + c_offset_len - 1 downto 0);
+	signal s_data_we : std_logic_vector(3 downto 0);
+	signal s_data_wdata : std_logic_vector(31 downto 0);
+	signal s_data_q : std_logic_vector(31 downto 0);
+
+	signal s_tag_waddr : unsigned(c_index_len - 1 downto 0);
+	signal s_tag_we : std_logic;
+	signal s_tag_wdata : std_logic_vector(c_tag_len downto 0);
+	signal s_tag_q : std_logic_vector(c_tag_len downto 0);
+
+	signal s_hit : std_logic;
+	signal s_init_line : unsigned(c_index_len - 1 downto 0);
+	signal s_issued : unsigned(c_offset_len downto 0);
+	signal s_received : unsigned(c_offset_len downto 0);
+	signal s_word : std_logic_vector(31 downto 0);
+
+	signal s_hits : unsigned(31 downto 0);
+	signal s_misses : unsigned(31 downto 0);
+
+begin
+
+	------------
+	-- Memory --
+	------------
+
+	s_index <= unsigned(i_wb_addr(c_tag_low - 1 downto c_index_low));
+	s_offset <= unsigned(i_wb_addr(c_index_low - 1 downto 2));
+	s_tag <= i_wb_addr(21 downto c_tag_low);
+
+	s_data_raddr <= s_index & s_offset;
+
+	lanes : for lane in 0 to 3 generate
+		signal s_lane : t_lane;
+	begin
+		data_ram : process(clk)
+		begin
+			if rising_edge(clk) then
+				if s_data_we(lane) = '1' then
+					s_lane(to_integer(s_data_waddr)) <= s_data_wdata(8 * lane + 7 downto 8 * lane);
+				end if;
+				s_data_q(8 * lane + 7 downto 8 * lane) <= s_lane(to_integer(s_data_raddr));
+			end if;
+		end process;
+	end generate;
+
+	tag_ram : process(clk)
+	begin
+		if rising_edge(clk) then
+			if s_tag_we = '1' then
+				s_tags(to_integer(s_tag_waddr)) <= s_tag_wdata;
+			end if;
+			s_tag_q <= s_tags(to_integer(s_index));
+		end if;
+	end process;
+
+	s_hit <= '1' when s_tag_q = '1' & s_tag else '0';
+
+	-- Line fills write whole words, write hits only the selected bytes
+	s_data_we <= (others => '1') when s_state = FILL and i_wb_sdram_ack = '1' else
+					 i_wb_sel when s_state = LOOKUP and i_wb_we = '1' and s_hit = '1' else
+					 (others => '0');
+	s_data_waddr <= s_index & s_received(c_offset_len - 1 downto 0) when s_state = FILL else
+						 s_data_raddr;
+	s_data_wdata <= i_wb_sdram_data when s_state = FILL else i_wb_data;
+
+	-- Lines are invalidated one per cycle after reset
+	s_tag_we <= '1' when s_state = INIT or
+							  (s_state = FILL and i_wb_sdram_ack = '1' and
+								s_received = g_LINE_WORDS - 1) else '0';
+	s_tag_waddr <= s_init_line when s_state = INIT else s_index;
+	s_tag_wdata <= (others => '0') when s_state = INIT else '1' & s_tag;
+
+	-------------------
+	-- State machine --
+	-------------------
+
+	control : process(clk, rst_n)
+	begin
+		if rst_n = '0' then
+			s_state <= INIT;
+			s_init_line <= (others => '0');
+			s_issued <= (others => '0');
+			s_received <= (others => '0');
+			s_word <= (others => '0');
+			s_hits <= (others => '0');
+			s_misses <= (others => '0');
+		elsif rising_edge(clk) then
+			case s_state is
+
+				when INIT =>
+					s_init_line <= s_init_line + 1;
+					if s_init_line = g_LINES - 1 then
+						s_state <= IDLE;
+					end if;
+
+				when IDLE =>
+					if i_wb_cyc = '1' and i_wb_stb = '1' then
+						s_state <= LOOKUP;
+					end if;
+
+				when LOOKUP =>
+					s_issued <= (others => '0');
+					s_received <= (others => '0');
+					if i_wb_we = '1' then
+						s_state <= WRITE;
+					elsif s_hit = '1' then
+						s_hits <= s_hits + 1;
+						s_state <= IDLE;
+					else
+						s_misses <= s_misses + 1;
+						s_state <= FILL;
+					end if;
+
+				when FILL =>
+					if s_issued < g_LINE_WORDS and i_wb_sdram_stall = '0' then
+						s_issued <= s_issued + 1;
+					end if;
+					if i_wb_sdram_ack = '1' then
+						if s_received(c_offset_len - 1 downto 0) = s_offset then
+							s_word <= i_wb_sdram_data;
+						end if;
+						s_received <= s_received + 1;
+						if s_received = g_LINE_WORDS - 1 then
+							s_state <= RESPOND;
+						end if;
+					end if;
+
+				when RESPOND =>
+					s_state <= IDLE;
+
+				when WRITE =>
+					if s_issued = 0 and i_wb_sdram_stall = '0' then
+						s_issued <= s_issued + 1;
+					end if;
+					if i_wb_sdram_ack = '1' then
+						s_state <= IDLE;
+					end if;
+
+			end case;
+		end if;
+	end process;
+
+	o_wb_stall <= '0' when s_state = IDLE else '1';
+	o_wb_ack <= '1' when (s_state = LOOKUP and i_wb_we = '0' and s_hit = '1') or
+								s_state = RESPOND or
+								(s_state = WRITE and i_wb_sdram_ack = '1') else '0';
+	o_wb_data <= s_data_q when s_state = LOOKUP else s_word;
+
+	o_wb_sdram_cyc <= '1' when s_state = FILL or s_state = WRITE else '0';
+	o_wb_sdram_stb <= '1' when (s_state = FILL and s_issued < g_LINE_WORDS) or
+										(s_state = WRITE and s_issued = 0) else '0';
+	o_wb_sdram_we <= '1' when s_state = WRITE else '0';
+	o_wb_sdram_addr <= i_wb_addr when s_state = WRITE else
+							 i_wb_addr(21 downto c_index_low) &
+							 std_logic_vector(s_issued(c_offset_len - 1 downto 0)) & "00";
+	o_wb_sdram_data <= i_wb_data;
+	o_wb_sdram_sel <= i_wb_sel when s_state = WRITE else (others => '1');
+
+	o_hits <= std_logic_vector(s_hits);
+	o_misses <= std_logic_vector(s_misses);
+
+end Behavioral;
@@ -0,0 +1,168 @@
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+-- Bus-master DMA controller with a single descriptor. Memory copies move
+-- whole words, ignoring the low bits of the addresses, while UART transfers
+-- read words and push their bytes into the selected transmit FIFO whenever
+-- it has room. The bus is released after every access, so that the CPU is
+-- granted every other one.
+
+entity DMA_Controller is
+	port (
+		clk : in std_logic;
+		rst_n : in std_logic;
+		-- Descriptor
+		i_src : in std_logic_vector(31 downto 0);
+		i_dst : in std_logic_vector(31 downto 0);
+		i_len : in std_logic_vector(31 downto 0);
+		i_mode : in std_logic_vector(1 downto 0);
+		i_start : in std_logic;
+		o_src : out std_logic_vector(31 downto 0);
+		o_dst : out std_logic_vector(31 downto 0);
+		o_len : out std_logic_vector(31 downto 0);
+		o_busy : out std_logic;
+		o_done : out std_logic;
+		-- Wishbone master
+		o_wb_cyc : out std_logic;
+		o_wb_stb : out std_logic;
+		o_wb_we : out std_logic;
+		o_wb_addr : out std_logic_vector(31 downto 0);
+		o_wb_data : out std_logic_vector(31 downto 0);
+		o_wb_sel : out std_logic_vector(3 downto 0);
+		i_wb_ack : in std_logic;
+		i_wb_data : in std_logic_vector(31 downto 0);
+		-- UART transmit FIFOs
+		i_uart0_tx_ready : in std_logic;
+		i_uart1_tx_ready : in std_logic;
+		o_uart0_tx_push : out std_logic;
+		o_uart1_tx_push : out std_logic;
+		o_uart_tx_data : out std_logic_vector(7 downto 0)
+	);
+end DMA_Controller;
+
+architecture Behavioral of DMA_Controller is
+
+	constant MODE_COPY	: std_logic_vector(1 downto 0) := "00";
+	constant MODE_UART0	: std_logic_vector(1 downto 0) := "01";
+	constant MODE_UART1	: std_logic_vector(1 downto 0) := "10";
+
+	type t_state is (IDLE, READ, WRITE, PUSH);
+	signal s_state : t_state;
+
+	signal s_src : unsigned(31 downto 0);
+	signal s_dst : unsigned(31 downto 0);
+	signal s_len : unsigned(31 downto 0);
+	signal s_mode : std_logic_vector(1 downto 0);
+	signal s_word : std_logic_vector(31 downto 0);
+	signal s_gap : std_logic;
+	signal s_done : std_logic;
+
+	signal s_bus : std_logic;
+	signal s_tx_ready : std_logic;
+	signal s_tx_push : std_logic;
+
+begin
+
+	control : process(clk, rst_n)
+	begin
+		if rst_n = '0' then
+			s_state <= IDLE;
+			s_src <= (others => '0');
+			s_dst <= (others => '0');
+			s_len <= (others => '0');
+			s_mode <= MODE_COPY;
+			s_word <= (others => '0');
+			s_gap <= '0';
+			s_done <= '0';
+		elsif rising_edge(clk) then
+			s_done <= '0';
+			s_gap <= '0';
+			case s_state is
+
+				when IDLE =>
+					if i_start = '1' then
+						s_src <= unsigned(i_src);
+						s_dst <= unsigned(i_dst);
+						s_len <= unsigned(i_len);
+						s_mode <= i_mode;
+						if unsigned(i_len) = 0 then
+							s_done <= '1';
+						else
+							s_state <= READ;
+						end if;
+					end if;
+
+				when READ =>
+					if s_bus = '1' and i_wb_ack = '1' then
+						s_word <= i_wb_data;
+						s_gap <= '1';
+						if s_mode = MODE_COPY then
+							s_state <= WRITE;
+						else
+							s_state <= PUSH;
+						end if;
+					end if;
+
+				when WRITE =>
+					if s_bus = '1' and i_wb_ack = '1' then
+						s_gap <= '1';
+						s_src <= s_src + 4;
+						s_dst <= s_dst + 4;
+						if s_len <= 4 then
+							s_len <= (others => '0');
+							s_done <= '1';
+							s_state <= IDLE;
+						else
+							s_len <= s_len - 4;
+							s_state <= READ;
+						end if;
+					end if;
+
+				when PUSH =>
+					if s_tx_push = '1' then
+						s_src <= s_src + 1;
+						s_len <= s_len - 1;
+						if s_len = 1 then
+							s_done <= '1';
+							s_state <= IDLE;
+						elsif s_src(1 downto 0) = "11" then
+							s_state <= READ;
+						end if;
+					end if;
+
+			end case;
+		end if;
+	end process;
+
+	-- Every access is followed by a cycle with the bus released
+	s_bus <= '1' when (s_state = READ or s_state = WRITE) and s_gap = '0' else '0';
+
+	o_wb_cyc <= s_bus;
+	o_wb_stb <= s_bus;
+	o_wb_we <= '1' when s_state = WRITE else '0';
+	o_wb_addr <= std_logic_vector(s_dst(31 downto 2)) & "00" when s_state = WRITE else
+					 std_logic_vector(s_src(31 downto 2)) & "00";
+	o_wb_data <= s_word;
+	o_wb_sel <= (others => '1');
+
+	-- Pushes follow the FIFO's ready flag of the same cycle, as it is updated
+	-- on the clock edge that stores the byte
+	s_tx_ready <= i_uart0_tx_ready when s_mode = MODE_UART0 else
+					  i_uart1_tx_ready when s_mode = MODE_UART1 else '0';
+	s_tx_push <= '1' when s_state = PUSH and s_tx_ready = '1' else '0';
+
+	o_uart0_tx_push <= s_tx_push when s_mode = MODE_UART0 else '0';
+	o_uart1_tx_push <= s_tx_push when s_mode = MODE_UART1 else '0';
+	o_uart_tx_data <= s_word(7 downto 0) when s_src(1 downto 0) = "00" else
+							s_word(15 downto 8) when s_src(1 downto 0) = "01" else
+							s_word(23 downto 16) when s_src(1 downto 0) = "10" else
+							s_word(31 downto 24);
+
+	o_src <= std_logic_vector(s_src);
+	o_dst <= std_logic_vector(s_dst);
+	o_len <= std_logic_vector(s_len);
+	o_busy <= '0' when s_state = IDLE else '1';
+	o_done <= s_done;
+
+end Behavioral;
@@ -0,0 +1,73 @@
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.std_logic_unsigned.all;
+use ieee.numeric_std.all;
+use IEEE.math_real.all;
+
+entity FIFO is
+	generic (
+		g_WIDTH : positive := 8;
+		g_DEPTH : positive := 16 -- power of two, at least 2
+	);
+	port (
+		clk : in std_logic;
+		rst_n : in std_logic;
+		i_push : in std_logic;
+		i_data : in std_logic_vector(g_WIDTH - 1 downto 0);
+		i_pop : in std_logic;
+		o_data : out std_logic_vector(g_WIDTH - 1 downto 0);
+		o_empty : out std_logic;
+		o_full : out std_logic;
+		o_level : out std_logic_vector(positive(ceil(log2(real(g_DEPTH)))) downto 0)
+	);
+end FIFO;
+
+architecture Behavioral of FIFO is
+
+	constant c_addr_len : positive := positive(ceil(log2(real(g_DEPTH))));
+
+	type t_memory is array (natural range 0 to g_DEPTH - 1) of std_logic_vector(g_WIDTH - 1 downto 0);
+
+	signal s_memory : t_memory;
+	signal s_head : std_logic_vector(c_addr_len downto 0);
+	signal s_tail : std_logic_vector(c_addr_len downto 0);
+	signal s_level : std_logic_vector(c_addr_len downto 0);
+	signal s_empty : std_logic;
+	signal s_full : std_logic;
+
+begin
+
+	s_level <= s_head - s_tail;
+	s_empty <= '1' when s_level = 0 else '0';
+	s_full <= '1' when s_level = g_DEPTH else '0';
+
+	o_data <= s_memory(to_integer(unsigned(s_tail(c_addr_len - 1 downto 0))));
+	o_empty <= s_empty;
+	o_full <= s_full;
+	o_level <= s_level;
+
+	memory : process(clk)
+	begin
+		if rising_edge(clk) then
+			if i_push = '1' and s_full = '0' then
+				s_memory(to_integer(unsigned(s_head(c_addr_len - 1 downto 0)))) <= i_data;
+			end if;
+		end if;
+	end process;
+
+	pointers : process(clk, rst_n)
+	begin
+		if rst_n = '0' then
+			s_head <= (others => '0');
+			s_tail <= (others => '0');
+		elsif rising_edge(clk) then
+			if i_push = '1' and s_full = '0' then
+				s_head <= s_head + 1;
+			end if;
+			if i_pop = '1' and s_empty = '0' then
+				s_tail <= s_tail + 1;
+			end if;
+		end if;
+	end process;
+
+end Behavioral;
@@ -6,7 +6,8 @@ use ieee.numeric_std.all;
 
 entity LPRS1_Board_GPIO is
 	generic (
-		g_NANOS_PER_CLK : positive := 20
+		g_NANOS_PER_CLK : positive := 20;
+		g_EVENT_FIFO_DEPTH : positive := 16
 	);
 	port (
 		clk : in std_logic;
@@ -16,10 +17,29 @@ entity LPRS1_Board_GPIO is
 		i_7segm_data : in std_logic_vector(32 downto 0);
 		i_disp_data : in std_logic_vector(31 downto 0);
 		i_disp_pos : in std_logic_vector(31 downto 0);
+		i_disp_we : in std_logic;
+		i_plane_data : in std_logic_vector(31 downto 0);
+		i_plane_index : in std_logic_vector(2 downto 0);
+		i_plane_sel : in std_logic_vector(3 downto 0);
+		i_plane_we : in std_logic;
+		i_swap : in std_logic;
+		o_swap_pending : out std_logic;
+		i_pwm_enable : in std_logic;
+		i_pwm_data : in std_logic_vector(31 downto 0);
+		i_pwm_addr : in std_logic_vector(4 downto 0);
+		i_pwm_sel : in std_logic_vector(3 downto 0);
+		i_pwm_we : in std_logic;
 		o_7segm_fb	: out std_logic_vector(31 downto 0);
 		o_row_digit : out std_logic_vector(2 downto 0);
 		o_col_7segm : out std_logic_vector(7 downto 0);
 		o_color_7segm : out std_logic_vector(1 downto 0);
+		i_micros : in std_logic_vector(31 downto 0);
+		i_debounce_us : in std_logic_vector(15 downto 0);
+		i_event_pop : in std_logic;
+		o_event : out std_logic_vector(36 downto 0);
+		o_event_valid : out std_logic;
+		o_event_overrun : out std_logic;
+		o_btn_sw : out std_logic_vector(12 downto 0);
 		o_btn_event : out std_logic;
 		o_sw_event : out std_logic
 	);
@@ -44,40 +64,162 @@ architecture Behavioral of LPRS1_Board_GPIO is
 	signal s_disp_r : DISPLAY_FB;
 	signal s_disp_g : DISPLAY_FB;
 	signal s_disp_b : DISPLAY_FB;
+	signal s_back_r : DISPLAY_FB;
+	signal s_back_g : DISPLAY_FB;
+	signal s_back_b : DISPLAY_FB;
+	signal s_frame_end : std_logic;
+	signal s_swap_pending : std_logic;
 
-	signal s_btn : std_logic_vector(4 downto 0);
-	signal s_btn_changed : std_logic;
+	-- 4 bit per channel pixels, three words per row and a bank per buffer
+	type PWM_LANE is array (natural range 0 to 47) of std_logic_vector(7 downto 0);
+	constant c_pwm_unit : positive := g_NANOS_PER_CLK * 1000 / 16;
+	signal s_pwm_bank : std_logic;
+	signal s_pwm_waddr : integer range 0 to 47;
+	signal s_pwm_raddr : integer range 0 to 47;
+	signal s_pwm_word : integer range 0 to 2;
+	signal s_pwm_q : std_logic_vector(31 downto 0);
+	signal s_pwm_row : std_logic_vector(95 downto 0);
+	signal s_pwm_tick : integer range 0 to c_pwm_unit - 1;
+	signal s_pwm_slot : unsigned(3 downto 0);
+	signal s_pwm_bit : integer range 0 to 3;
+	signal s_pwm_channel : integer range 0 to 2;
+	signal s_pwm_col : std_logic_vector(7 downto 0);
 
-	signal s_sw : std_logic_vector(7 downto 0);
-	signal s_sw_changed : std_logic;
+	-- Buttons and switches in the order of the register, switches first
+	type INPUT_COUNTERS is array (natural range 0 to 12) of unsigned(15 downto 0);
+	constant c_micro_clks : positive := 1000 / g_NANOS_PER_CLK;
+	signal s_input_meta : std_logic_vector(12 downto 0);
+	signal s_input_sync : std_logic_vector(12 downto 0);
+	signal s_input : std_logic_vector(12 downto 0);
+	signal s_input_counters : INPUT_COUNTERS;
+	signal s_input_pending : std_logic_vector(12 downto 0);
+	signal s_micro_timer : integer range 0 to c_micro_clks - 1;
+	signal s_micro_tick : std_logic;
+
+	signal s_event_push : std_logic;
+	signal s_event_data : std_logic_vector(36 downto 0);
+	signal s_event_empty : std_logic;
+	signal s_event_full : std_logic;
+	signal s_event_overrun : std_logic;
 
 begin
 
-	s_btn_changed <= or_reduce(i_btn xor s_btn);
-	s_sw_changed <= or_reduce(i_sw xor s_sw);
+	----------------------
+	-- Input debouncing --
+	----------------------
+
+	micro_tick : process(clk, rst_n)
+	begin
+		if rst_n = '0' then
+			s_micro_timer <= 0;
+			s_micro_tick <= '0';
+		elsif rising_edge(clk) then
+			if s_micro_timer = c_micro_clks - 1 then
+				s_micro_timer <= 0;
+				s_micro_tick <= '1';
+			else
+				s_micro_timer <= s_micro_timer + 1;
+				s_micro_tick <= '0';
+			end if;
+		end if;
+	end process;
 
-	input_events : process(clk, rst_n)
+	-- An input changes once it was stable for the debounce time, and each
+	-- change is queued with its time until it can be pushed
+	input_debounce : process(clk, rst_n)
+		variable pushed : boolean;
 	begin
 		if rst_n = '0' then
+			s_input_meta <= (others => '0');
+			s_input_sync <= (others => '0');
+			s_input <= (others => '0');
+			s_input_counters <= (others => (others => '0'));
+			s_input_pending <= (others => '0');
+			s_event_push <= '0';
+			s_event_data <= (others => '0');
 			o_btn_event <= '0';
 			o_sw_event <= '0';
-			s_btn <= (others => '0');
-			s_sw <= (others => '0');
 		elsif rising_edge(clk) then
-			-- Buttons
-			o_btn_event <= s_btn_changed;
-			s_btn <= i_btn;
-			-- Switches
-			o_sw_event <= s_sw_changed;
-			s_sw <= i_sw;
+			s_input_meta <= i_btn & i_sw;
+			s_input_sync <= s_input_meta;
+			o_btn_event <= '0';
+			o_sw_event <= '0';
+
+			-- One event per cycle, lowest input first
+			s_event_push <= '0';
+			pushed := false;
+			for i in 0 to 12 loop
+				if not pushed and s_input_pending(i) = '1' then
+					s_event_data <= i_micros & s_input(i) & std_logic_vector(to_unsigned(i, 4));
+					s_event_push <= '1';
+					s_input_pending(i) <= '0';
+					pushed := true;
+				end if;
+			end loop;
+
+			-- A change in the same cycle stays pending over the push above
+			for i in 0 to 12 loop
+				if s_input_sync(i) = s_input(i) then
+					s_input_counters(i) <= (others => '0');
+				elsif s_input_counters(i) >= unsigned(i_debounce_us) then
+					s_input(i) <= s_input_sync(i);
+					s_input_counters(i) <= (others => '0');
+					s_input_pending(i) <= '1';
+					if i >= 8 then
+						o_btn_event <= '1';
+					else
+						o_sw_event <= '1';
+					end if;
+				elsif s_micro_tick = '1' then
+					s_input_counters(i) <= s_input_counters(i) + 1;
+				end if;
+			end loop;
+		end if;
+	end process;
+
+	o_btn_sw <= s_input;
+
+	event_fifo : entity work.FIFO
+		generic map (
+			g_WIDTH => 37,
+			g_DEPTH => g_EVENT_FIFO_DEPTH
+		)
+		port map (
+			clk => clk,
+			rst_n => rst_n,
+			i_push => s_event_push,
+			i_data => s_event_data,
+			i_pop => i_event_pop,
+			o_data => o_event,
+			o_empty => s_event_empty,
+			o_full => s_event_full,
+			o_level => open
+		);
+
+	-- Set when an event was dropped, until the next one is read
+	event_overrun : process(clk, rst_n)
+	begin
+		if rst_n = '0' then
+			s_event_overrun <= '0';
+		elsif rising_edge(clk) then
+			if s_event_push = '1' and s_event_full = '1' then
+				s_event_overrun <= '1';
+			elsif i_event_pop = '1' then
+				s_event_overrun <= '0';
+			end if;
 		end if;
 	end process;
 
+	o_event_valid <= not s_event_empty;
+	o_event_overrun <= s_event_overrun;
+
 	output_mux : process(clk, rst_n)
 	begin
 		if rst_n = '0' then
 			s_display_timer <= (others => '0');
 			s_mux <= (others => '0');
+			s_pwm_tick <= 0;
+			s_pwm_slot <= (others => '0');
 		elsif rising_edge(clk) then
 			if s_display_timer > g_NANOS_PER_CLK * 1000 then
 				if s_mux < 36 then
@@ -86,13 +228,87 @@ begin
 					s_mux <= (others => '0');
 				end if;
 				s_display_timer <= (others => '0');
+				s_pwm_tick <= 0;
+				s_pwm_slot <= (others => '0');
 			else
 				s_display_timer <= s_display_timer + 1;
 				s_mux <= s_mux;
+				-- Each row is shown for sixteen units, the first one blank
+				if s_pwm_tick = c_pwm_unit - 1 then
+					s_pwm_tick <= 0;
+					if s_pwm_slot /= 15 then
+						s_pwm_slot <= s_pwm_slot + 1;
+					end if;
+				else
+					s_pwm_tick <= s_pwm_tick + 1;
+				end if;
 			end if;
 		end if;
 	end process;
-	
+
+	----------------------------
+	-- Binary code modulation --
+	----------------------------
+
+	-- Pixels are written into the bank which is not displayed
+	s_pwm_waddr <= to_integer(unsigned(i_pwm_addr)) + 24 when s_pwm_bank = '0' else
+						to_integer(unsigned(i_pwm_addr));
+
+	-- The three words of the displayed row are read at the start of its step
+	s_pwm_word <= 2 when s_display_timer(1 downto 0) = "11" else
+					  to_integer(unsigned(s_display_timer(1 downto 0)));
+	s_pwm_raddr <= to_integer(unsigned(s_row_digit)) * 3 + s_pwm_word when s_pwm_bank = '0' else
+						to_integer(unsigned(s_row_digit)) * 3 + s_pwm_word + 24;
+
+	pwm_lanes : for lane in 0 to 3 generate
+		signal s_lane : PWM_LANE;
+	begin
+		pwm_ram : process(clk)
+		begin
+			if rising_edge(clk) then
+				if i_pwm_we = '1' and i_pwm_sel(lane) = '1' then
+					s_lane(s_pwm_waddr) <= i_pwm_data(8 * lane + 7 downto 8 * lane);
+				end if;
+				s_pwm_q(8 * lane + 7 downto 8 * lane) <= s_lane(s_pwm_raddr);
+			end if;
+		end process;
+	end generate;
+
+	pwm_row : process(clk, rst_n)
+	begin
+		if rst_n = '0' then
+			s_pwm_row <= (others => '0');
+		elsif rising_edge(clk) then
+			case to_integer(unsigned(s_display_timer)) is
+				when 1 => s_pwm_row(31 downto 0) <= s_pwm_q;
+				when 2 => s_pwm_row(63 downto 32) <= s_pwm_q;
+				when 3 => s_pwm_row(95 downto 64) <= s_pwm_q;
+				when others => null;
+			end case;
+		end if;
+	end process;
+
+	-- Bit k of a channel is shown for 2^k units, after the unit of blanking
+	s_pwm_bit <= 3 when s_pwm_slot(3) = '1' else
+					 2 when s_pwm_slot(2) = '1' else
+					 1 when s_pwm_slot(1) = '1' else
+					 0;
+	s_pwm_channel <= 2 when s_color_7segm = "00" else
+						  1 when s_color_7segm = "01" else
+						  0;
+
+	pwm_columns : process(s_pwm_row, s_pwm_slot, s_pwm_bit, s_pwm_channel)
+		variable column : integer;
+	begin
+		s_pwm_col <= (others => '0');
+		if s_pwm_slot /= 0 then
+			for x in 0 to 7 loop
+				column := (7 - x - 2) mod 8;
+				s_pwm_col(column) <= s_pwm_row(12 * x + 4 * s_pwm_channel + s_pwm_bit);
+			end loop;
+		end if;
+	end process;
+
 	s_color_7segm <= "00" when s_mux < 8 else
 						  "01" when s_mux < 16 else
 						  "10" when s_mux < 24 else
@@ -107,7 +323,8 @@ begin
 						"110" when s_mux = 6 or s_mux = 14 or s_mux = 22 else
 						"111";
 	
-	s_disp_col <= s_disp_r(to_integer(unsigned(s_row_digit))) when s_color_7segm = "00" else
+	s_disp_col <= s_pwm_col when i_pwm_enable = '1' else
+					  s_disp_r(to_integer(unsigned(s_row_digit))) when s_color_7segm = "00" else
 					  s_disp_g(to_integer(unsigned(s_row_digit))) when s_color_7segm = "01" else
 					  s_disp_b(to_integer(unsigned(s_row_digit))) when s_color_7segm = "10" else
 					  (others => '0');
@@ -124,15 +341,53 @@ begin
 			s_disp_r <= ((others => (others=>'0')));
 			s_disp_g <= ((others => (others=>'0')));
 			s_disp_b <= ((others => (others=>'0')));
+			s_back_r <= ((others => (others=>'0')));
+			s_back_g <= ((others => (others=>'0')));
+			s_back_b <= ((others => (others=>'0')));
+			s_swap_pending <= '0';
+			s_pwm_bank <= '0';
 		elsif rising_edge(clk) then
-			column := (7 - to_integer(unsigned(i_disp_pos)) / 8 - 2) mod 8;
-			row := to_integer(unsigned(i_disp_pos)) mod 8;
-			s_disp_r(row)(column) <= i_disp_data(0);
-			s_disp_g(row)(column) <= i_disp_data(1);
-			s_disp_b(row)(column) <= i_disp_data(2);
+			if i_disp_we = '1' then
+				column := (7 - to_integer(unsigned(i_disp_pos)) / 8 - 2) mod 8;
+				row := to_integer(unsigned(i_disp_pos)) mod 8;
+				s_disp_r(row)(column) <= i_disp_data(0);
+				s_disp_g(row)(column) <= i_disp_data(1);
+				s_disp_b(row)(column) <= i_disp_data(2);
+			end if;
+
+			-- Planes hold four rows per word, with columns in pixel order
+			if i_plane_we = '1' then
+				for lane in 0 to 3 loop
+					if i_plane_sel(lane) = '1' then
+						row := to_integer(unsigned(i_plane_index(0 downto 0))) * 4 + lane;
+						for x in 0 to 7 loop
+							column := (7 - x - 2) mod 8;
+							case i_plane_index(2 downto 1) is
+								when "00" => s_back_r(row)(column) <= i_plane_data(8 * lane + x);
+								when "01" => s_back_g(row)(column) <= i_plane_data(8 * lane + x);
+								when others => s_back_b(row)(column) <= i_plane_data(8 * lane + x);
+							end case;
+						end loop;
+					end if;
+				end loop;
+			end if;
+
+			-- The back buffer is shown from the next frame, so it never tears
+			if i_swap = '1' then
+				s_swap_pending <= '1';
+			elsif s_swap_pending = '1' and s_frame_end = '1' then
+				s_disp_r <= s_back_r;
+				s_disp_g <= s_back_g;
+				s_disp_b <= s_back_b;
+				s_pwm_bank <= not s_pwm_bank;
+				s_swap_pending <= '0';
+			end if;
 		end if;
 	end process;
 
+	s_frame_end <= '1' when s_mux >= 36 and s_display_timer > g_NANOS_PER_CLK * 1000 else '0';
+	o_swap_pending <= s_swap_pending;
+
 	select_digit : process(s_row_digit, i_7segm_data)
 	begin
 		case s_row_digit(1 downto 0) is
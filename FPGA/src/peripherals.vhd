@@ -3,10 +3,13 @@ use ieee.std_logic_1164.all;
 use ieee.std_logic_unsigned.all;
 use ieee.std_logic_misc.all;
 use ieee.numeric_std.all;
+use IEEE.math_real.all;
 
 entity Peripherals is
 	generic (
-		g_CLK_FREQ_HZ : positive := 50_000_000
+		g_CLK_FREQ_HZ : positive := 50_000_000;
+		g_UART_FIFO_DEPTH : positive := 16;
+		g_DEBOUNCE_US : natural := 5000
 	);
 	port (
 		clk : in std_logic;
@@ -42,6 +45,19 @@ entity Peripherals is
 		-- UART 1
 		i_uart1_rx : in std_logic;
 		o_uart1_tx : out std_logic;
+		-- SDRAM cache
+		i_cache_hits : in std_logic_vector(31 downto 0);
+		i_cache_misses : in std_logic_vector(31 downto 0);
+		-- DMA bus master
+		o_wb_dma_cyc : out std_logic;
+		o_wb_dma_stb : out std_logic;
+		o_wb_dma_we : out std_logic;
+		o_wb_dma_addr : out std_logic_vector(31 downto 0);
+		o_wb_dma_data : out std_logic_vector(31 downto 0);
+		o_wb_dma_sel : out std_logic_vector(3 downto 0);
+		i_wb_dma_stall : in std_logic;
+		i_wb_dma_ack : in std_logic;
+		i_wb_dma_data : in std_logic_vector(31 downto 0);
 		-- External IRQ
 		i_eoi : in std_logic_vector(31 downto 0);
 		o_irq : out std_logic_vector(31 downto 0)
@@ -58,22 +74,50 @@ architecture Behavioral of Peripherals is
 
 	signal s_disp_data : std_logic_vector(31 downto 0);
 	signal s_disp_pos : std_logic_vector(31 downto 0);
+	signal s_disp_we : std_logic;
+	signal s_disp_plane_data : std_logic_vector(31 downto 0);
+	signal s_disp_plane_index : std_logic_vector(2 downto 0);
+	signal s_disp_plane_sel : std_logic_vector(3 downto 0);
+	signal s_disp_plane_we : std_logic;
+	signal s_disp_swap : std_logic;
+	signal s_disp_swap_pending : std_logic;
+	signal s_disp_pwm : std_logic;
+	signal s_disp_pwm_data : std_logic_vector(31 downto 0);
+	signal s_disp_pwm_addr : std_logic_vector(4 downto 0);
+	signal s_disp_pwm_sel : std_logic_vector(3 downto 0);
+	signal s_disp_pwm_we : std_logic;
+
+	constant c_uart_level_len : positive := positive(ceil(log2(real(g_UART_FIFO_DEPTH)))) + 1;
 
 	signal s_uart0_rx_byte : std_logic_vector(7 downto 0);
 	signal s_uart0_rx_dv : std_logic;
+	signal s_uart0_rx_pop : std_logic;
+	signal s_uart0_rx_level : std_logic_vector(c_uart_level_len - 1 downto 0);
+	signal s_uart0_rx_threshold : std_logic;
+	signal s_uart0_rx_idle : std_logic;
+	signal s_uart0_rx_overrun : std_logic;
+	signal s_uart0_rx_overrun_clr : std_logic;
 
 	signal s_uart1_rx_byte : std_logic_vector(7 downto 0);
 	signal s_uart1_rx_dv : std_logic;
+	signal s_uart1_rx_pop : std_logic;
+	signal s_uart1_rx_level : std_logic_vector(c_uart_level_len - 1 downto 0);
+	signal s_uart1_rx_threshold : std_logic;
+	signal s_uart1_rx_idle : std_logic;
+	signal s_uart1_rx_overrun : std_logic;
+	signal s_uart1_rx_overrun_clr : std_logic;
 
 	signal s_uart0_tx_byte : std_logic_vector(7 downto 0);
-	signal s_uart0_tx_dv : std_logic;
-	signal s_uart0_tx_active : std_logic;
+	signal s_uart0_tx_push : std_logic;
 	signal s_uart0_tx_done : std_logic;
+	signal s_uart0_tx_level : std_logic_vector(c_uart_level_len - 1 downto 0);
+	signal s_uart0_tx_threshold : std_logic;
 
 	signal s_uart1_tx_byte : std_logic_vector(7 downto 0);
-	signal s_uart1_tx_dv : std_logic;
-	signal s_uart1_tx_active : std_logic;
+	signal s_uart1_tx_push : std_logic;
 	signal s_uart1_tx_done : std_logic;
+	signal s_uart1_tx_level : std_logic_vector(c_uart_level_len - 1 downto 0);
+	signal s_uart1_tx_threshold : std_logic;
 
 	signal s_uart0_rx_ready : std_logic;
 	signal s_uart0_tx_ready : std_logic;
@@ -85,7 +129,12 @@ architecture Behavioral of Peripherals is
 	signal s_uart0_ncts : std_logic;
 
 	signal s_btn_sw : std_logic_vector(12 downto 0);
-	signal s_btn_sw_changed : std_logic;
+	signal s_input_event : std_logic_vector(36 downto 0);
+	signal s_input_event_valid : std_logic;
+	signal s_input_event_overrun : std_logic;
+	signal s_input_event_pop : std_logic;
+	signal s_input_time : std_logic_vector(31 downto 0);
+	signal s_input_debounce : std_logic_vector(15 downto 0);
 
 	signal s_runtime_ns : std_logic_vector(63 downto 0);
 	signal s_runtime_us : std_logic_vector(63 downto 0);
@@ -95,6 +144,23 @@ architecture Behavioral of Peripherals is
 	signal s_timer_sel : std_logic_vector(1 downto 0);
 	signal s_timer_int : std_logic_vector(31 downto 0);
 
+	signal s_dma_src : std_logic_vector(31 downto 0);
+	signal s_dma_dst : std_logic_vector(31 downto 0);
+	signal s_dma_len : std_logic_vector(31 downto 0);
+	signal s_dma_mode : std_logic_vector(1 downto 0);
+	signal s_dma_start : std_logic;
+	signal s_dma_cur_src : std_logic_vector(31 downto 0);
+	signal s_dma_cur_dst : std_logic_vector(31 downto 0);
+	signal s_dma_cur_len : std_logic_vector(31 downto 0);
+	signal s_dma_busy : std_logic;
+	signal s_dma_uart0_tx_push : std_logic;
+	signal s_dma_uart1_tx_push : std_logic;
+	signal s_dma_uart_tx_byte : std_logic_vector(7 downto 0);
+	signal s_uart0_tx_fifo_push : std_logic;
+	signal s_uart0_tx_fifo_byte : std_logic_vector(7 downto 0);
+	signal s_uart1_tx_fifo_push : std_logic;
+	signal s_uart1_tx_fifo_byte : std_logic_vector(7 downto 0);
+
 	signal s_wb_ack : std_logic;
 	signal s_wb_stall : std_logic;
 	signal s_wb_sel_mask : std_logic_vector(31 downto 0);
@@ -135,6 +201,34 @@ architecture Behavioral of Peripherals is
 	constant ADDR_7SEGM			: integer := 16#0058#;	--  32bit rw	7segm custom
 	constant ADDR_DISP			: integer := 16#005C#;	-- 192bit rw	LED matrix framebuffer
 
+	-- UART FIFO
+	constant ADDR_UART0_RX_LVL	: integer := 16#0160#;	--  32bit ro UART receive FIFO level and overrun
+	constant ADDR_UART0_TX_LVL	: integer := 16#0164#;	--  32bit ro UART transmit FIFO level
+	constant ADDR_UART1_RX_LVL	: integer := 16#0168#;	--  32bit ro UART receive FIFO level and overrun
+	constant ADDR_UART1_TX_LVL	: integer := 16#016C#;	--  32bit ro UART transmit FIFO level
+	constant ADDR_UART_FIFO_SZ	: integer := 16#0170#;	--  32bit ro UART FIFO depth
+
+	-- SDRAM cache
+	constant ADDR_CACHE_HITS	: integer := 16#0180#;	--  32bit ro Cache read hits
+	constant ADDR_CACHE_MISSES	: integer := 16#0184#;	--  32bit ro Cache read misses
+
+	-- DMA
+	constant ADDR_DMA_SRC		: integer := 16#0190#;	--  32bit rw DMA source address
+	constant ADDR_DMA_DST		: integer := 16#0194#;	--  32bit rw DMA destination address
+	constant ADDR_DMA_LEN		: integer := 16#0198#;	--  32bit rw DMA length in bytes
+	constant ADDR_DMA_CTRL		: integer := 16#019C#;	--   3bit rw DMA mode and start, busy
+
+	-- LED matrix back buffer
+	constant ADDR_DISP_PLANE	: integer := 16#01A0#;	-- 192bit wo	Red, green and blue planes, a byte per row
+	constant ADDR_DISP_SWAP		: integer := 16#01B8#;	--   1bit rw	Swap at the end of the frame, pending
+	constant ADDR_DISP_MODE		: integer := 16#01BC#;	--   1bit rw	4bit per channel modulation enable
+
+	-- Debounced input events
+	constant ADDR_INPUT_EVENT	: integer := 16#01C0#;	--  32bit ro Pop input event: valid, overrun, edge and input
+	constant ADDR_INPUT_TIME	: integer := 16#01C4#;	--  32bit ro Microseconds of the last popped event
+	constant ADDR_INPUT_DEBOUNCE	: integer := 16#01C8#;	--  16bit rw Input debounce time (us)
+	constant ADDR_DISP_PWM		: integer := 16#0300#;	-- 768bit wo	12bit pixels, three words per row
+
 	-------------------------------
 	-- Interrupt register bitmap --
 	-------------------------------
@@ -145,6 +239,10 @@ architecture Behavioral of Peripherals is
 	constant IRQ_TIMER3			: integer := 7;	--   Timer 3 interval has elapsed
 	constant IRQ_UART_RX			: integer := 8;	--   UART byte received
 	constant IRQ_UART_TX			: integer := 9;	--   UART byte transmitted
+	constant IRQ_UART_RX_THR	: integer := 10;	--   UART receive FIFO half full
+	constant IRQ_UART_TX_THR	: integer := 11;	--   UART transmit FIFO almost empty
+	constant IRQ_DMA				: integer := 12;	--   DMA transfer completed
+	constant IRQ_UART_RX_IDLE	: integer := 13;	--   UART receive line idle with FIFO not empty
 	constant IRQ_BTN				: integer := 30;	--   Button interaction event
 	constant IRQ_SW				: integer := 31;	--   Switch interaction event
 
@@ -171,52 +269,87 @@ begin
 			o_runtime_ms		=> s_runtime_ms
 		);
 
-	uart0_rx : entity work.UART_RX
+	uart0 : entity work.UART_Buffered
 		generic map (
-			g_CLKS_PER_BIT => g_CLK_FREQ_HZ / 115_200 -- 115200 bps
+			g_CLKS_PER_BIT 	=> g_CLK_FREQ_HZ / 115_200, -- 115200 bps
+			g_FIFO_DEPTH 		=> g_UART_FIFO_DEPTH
 		)
 		port map (
-			i_Clk       => clk,
-			i_RX_Serial => i_uart0_rx,
-			o_RX_DV     => s_uart0_rx_dv,
-			o_RX_Byte   => s_uart0_rx_byte
+			clk 					=> clk,
+			rst_n 				=> rst_n,
+			i_rx 					=> i_uart0_rx,
+			o_tx 					=> o_uart0_tx,
+			i_tx_push 			=> s_uart0_tx_fifo_push,
+			i_tx_data 			=> s_uart0_tx_fifo_byte,
+			o_tx_ready 			=> s_uart0_tx_ready,
+			o_tx_level 			=> s_uart0_tx_level,
+			o_tx_done 			=> s_uart0_tx_done,
+			o_tx_threshold 	=> s_uart0_tx_threshold,
+			i_rx_pop 			=> s_uart0_rx_pop,
+			o_rx_data 			=> s_uart0_rx_byte,
+			o_rx_ready 			=> s_uart0_rx_ready,
+			o_rx_level 			=> s_uart0_rx_level,
+			o_rx_dv 				=> s_uart0_rx_dv,
+			o_rx_threshold 	=> s_uart0_rx_threshold,
+			o_rx_idle 			=> s_uart0_rx_idle,
+			i_rx_overrun_clr 	=> s_uart0_rx_overrun_clr,
+			o_rx_overrun 		=> s_uart0_rx_overrun
 		);
 
-	uart1_rx : entity work.UART_RX
+	uart1 : entity work.UART_Buffered
 		generic map (
-			g_CLKS_PER_BIT => g_CLK_FREQ_HZ / 2_000_000 -- 2 Mbps
+			g_CLKS_PER_BIT 	=> g_CLK_FREQ_HZ / 2_000_000, -- 2 Mbps
+			g_FIFO_DEPTH 		=> g_UART_FIFO_DEPTH
 		)
 		port map (
-			i_Clk       => clk,
-			i_RX_Serial => i_uart1_rx,
-			o_RX_DV     => s_uart1_rx_dv,
-			o_RX_Byte   => s_uart1_rx_byte
+			clk 					=> clk,
+			rst_n 				=> rst_n,
+			i_rx 					=> i_uart1_rx,
+			o_tx 					=> o_uart1_tx,
+			i_tx_push 			=> s_uart1_tx_fifo_push,
+			i_tx_data 			=> s_uart1_tx_fifo_byte,
+			o_tx_ready 			=> s_uart1_tx_ready,
+			o_tx_level 			=> s_uart1_tx_level,
+			o_tx_done 			=> s_uart1_tx_done,
+			o_tx_threshold 	=> s_uart1_tx_threshold,
+			i_rx_pop 			=> s_uart1_rx_pop,
+			o_rx_data 			=> s_uart1_rx_byte,
+			o_rx_ready 			=> s_uart1_rx_ready,
+			o_rx_level 			=> s_uart1_rx_level,
+			o_rx_dv 				=> s_uart1_rx_dv,
+			o_rx_threshold 	=> s_uart1_rx_threshold,
+			o_rx_idle 			=> s_uart1_rx_idle,
+			i_rx_overrun_clr 	=> s_uart1_rx_overrun_clr,
+			o_rx_overrun 		=> s_uart1_rx_overrun
 		);
 
-	uart0_tx : entity work.UART_TX
-		generic map (
-			g_CLKS_PER_BIT => g_CLK_FREQ_HZ / 115_200 -- 115200 bps
-		)
+	dma : entity work.DMA_Controller
 		port map (
-			i_Clk       => clk,
-			i_TX_DV     => s_uart0_tx_dv,
-			i_TX_Byte   => s_uart0_tx_byte,
-			o_TX_Active => s_uart0_tx_active,
-			o_TX_Serial => o_uart0_tx,
-			o_TX_Done   => s_uart0_tx_done
-		);
-
-	uart1_tx : entity work.UART_TX
-		generic map (
-			g_CLKS_PER_BIT => g_CLK_FREQ_HZ / 2_000_000 -- 2 Mbps
-		)
-		port map (
-			i_Clk       => clk,
-			i_TX_DV     => s_uart1_tx_dv,
-			i_TX_Byte   => s_uart1_tx_byte,
-			o_TX_Active => s_uart1_tx_active,
-			o_TX_Serial => o_uart1_tx,
-			o_TX_Done   => s_uart1_tx_done
+			clk 					=> clk,
+			rst_n 				=> rst_n,
+			i_src					=> s_dma_src,
+			i_dst					=> s_dma_dst,
+			i_len					=> s_dma_len,
+			i_mode				=> s_dma_mode,
+			i_start				=> s_dma_start,
+			o_src					=> s_dma_cur_src,
+			o_dst					=> s_dma_cur_dst,
+			o_len					=> s_dma_cur_len,
+			o_busy				=> s_dma_busy,
+			o_done				=> s_irq(IRQ_DMA),
+			o_wb_cyc				=> o_wb_dma_cyc,
+			o_wb_stb				=> o_wb_dma_stb,
+			o_wb_we				=> o_wb_dma_we,
+			o_wb_addr			=> o_wb_dma_addr,
+			o_wb_data			=> o_wb_dma_data,
+			o_wb_sel				=> o_wb_dma_sel,
+			i_wb_ack				=> i_wb_dma_ack,
+			i_wb_data			=> i_wb_dma_data,
+			i_uart0_tx_ready	=> s_uart0_tx_ready,
+			i_uart1_tx_ready	=> s_uart1_tx_ready,
+			o_uart0_tx_push	=> s_dma_uart0_tx_push,
+			o_uart1_tx_push	=> s_dma_uart1_tx_push,
+			o_uart_tx_data		=> s_dma_uart_tx_byte
 		);
 
 	lprs1_board_gpio : entity work.LPRS1_Board_GPIO
@@ -231,10 +364,29 @@ begin
 			i_7segm_data	=> s_7segm,
 			i_disp_data		=> s_disp_data,
 			i_disp_pos		=> s_disp_pos,
+			i_disp_we		=> s_disp_we,
+			i_plane_data	=> s_disp_plane_data,
+			i_plane_index	=> s_disp_plane_index,
+			i_plane_sel		=> s_disp_plane_sel,
+			i_plane_we		=> s_disp_plane_we,
+			i_swap			=> s_disp_swap,
+			o_swap_pending	=> s_disp_swap_pending,
+			i_pwm_enable	=> s_disp_pwm,
+			i_pwm_data		=> s_disp_pwm_data,
+			i_pwm_addr		=> s_disp_pwm_addr,
+			i_pwm_sel		=> s_disp_pwm_sel,
+			i_pwm_we			=> s_disp_pwm_we,
 			o_7segm_fb		=> s_7segm_fb,
 			o_row_digit		=> o_mux_row_or_digit,
 			o_col_7segm		=> o_n_col_or_7segm,
 			o_color_7segm	=> o_mux_sel_color_or_7segm,
+			i_micros			=> s_runtime_us(31 downto 0),
+			i_debounce_us	=> s_input_debounce,
+			i_event_pop		=> s_input_event_pop,
+			o_event			=> s_input_event,
+			o_event_valid	=> s_input_event_valid,
+			o_event_overrun	=> s_input_event_overrun,
+			o_btn_sw			=> s_btn_sw,
 			o_btn_event		=> s_irq(IRQ_BTN),
 			o_sw_event		=> s_irq(IRQ_SW)
 		);
@@ -250,15 +402,24 @@ begin
 	o_uart0_ndsr <= s_uart0_ndsr;
 	o_uart0_ncts <= s_uart0_ncts;
 
+	-- Transmit FIFOs are shared between the bus and the DMA controller
+	s_uart0_tx_fifo_push <= s_uart0_tx_push or s_dma_uart0_tx_push;
+	s_uart0_tx_fifo_byte <= s_dma_uart_tx_byte when s_dma_uart0_tx_push = '1' else s_uart0_tx_byte;
+	s_uart1_tx_fifo_push <= s_uart1_tx_push or s_dma_uart1_tx_push;
+	s_uart1_tx_fifo_byte <= s_dma_uart_tx_byte when s_dma_uart1_tx_push = '1' else s_uart1_tx_byte;
+
 	----------------
 	-- Interrupts --
 	----------------
 	
 	s_irq(3 downto 0) <= (others => '0'); -- internal
-	s_irq(29 downto 10) <= (others => '0'); -- unused
+	s_irq(29 downto 14) <= (others => '0'); -- unused
 	
 	s_irq(IRQ_UART_RX) <= s_uart0_rx_dv or s_uart1_rx_dv;
 	s_irq(IRQ_UART_TX) <= s_uart0_tx_done or s_uart1_tx_done;
+	s_irq(IRQ_UART_RX_THR) <= s_uart0_rx_threshold or s_uart1_rx_threshold;
+	s_irq(IRQ_UART_TX_THR) <= s_uart0_tx_threshold or s_uart1_tx_threshold;
+	s_irq(IRQ_UART_RX_IDLE) <= s_uart0_rx_idle or s_uart1_rx_idle;
 	
 	o_irq <= s_irq;
 
@@ -266,8 +427,8 @@ begin
 	-- Wishbone bus --
 	------------------
 
-	s_uart0_tx_ready <= not s_uart0_tx_active and not s_uart0_tx_dv;
-	s_uart1_tx_ready <= not s_uart1_tx_active and not s_uart1_tx_dv;
+	-- Strobe stays high during the acknowledge cycle, so FIFO accesses
+	-- are only performed in the first cycle of each bus transaction.
 
 	wb_write : process(clk, rst_n)
 	begin
@@ -277,21 +438,45 @@ begin
 			s_7segm <= "100001110011001110000010101011011"; -- LPrS
 			s_disp_data <= (others => '0');
 			s_disp_pos <= (others => '0');
+			s_disp_we <= '0';
+			s_disp_plane_data <= (others => '0');
+			s_disp_plane_index <= (others => '0');
+			s_disp_plane_sel <= (others => '0');
+			s_disp_plane_we <= '0';
+			s_disp_swap <= '0';
+			s_disp_pwm <= '0';
+			s_disp_pwm_data <= (others => '0');
+			s_disp_pwm_addr <= (others => '0');
+			s_disp_pwm_sel <= (others => '0');
+			s_disp_pwm_we <= '0';
+			s_input_debounce <= std_logic_vector(to_unsigned(g_DEBOUNCE_US, s_input_debounce'length));
 
 			s_uart0_tx_byte <= (others => '0');
-			s_uart0_tx_dv <= '0';
+			s_uart0_tx_push <= '0';
 
 			s_uart1_tx_byte <= (others => '0');
-			s_uart1_tx_dv <= '0';
+			s_uart1_tx_push <= '0';
 
 			s_timer_rst <= (others => '1');
 			s_timer_sel <= (others => '0');
 			s_timer_int <= (others => '1');
 
+			s_dma_src <= (others => '0');
+			s_dma_dst <= (others => '0');
+			s_dma_len <= (others => '0');
+			s_dma_mode <= (others => '0');
+			s_dma_start <= '0';
+
 		elsif rising_edge(clk) then
+			s_uart0_tx_push <= '0';
+			s_uart1_tx_push <= '0';
+			s_dma_start <= '0';
+			s_disp_we <= '0';
+			s_disp_plane_we <= '0';
+			s_disp_swap <= '0';
+			s_disp_pwm_we <= '0';
+
 			if i_wb_stb = '1' and i_wb_we = '1' then
-				s_uart0_tx_dv <= '0';
-				s_uart1_tx_dv <= '0';
 
 				-- LED and Semaphore
 				if i_wb_addr = ADDR_LED_SEM then
@@ -317,20 +502,45 @@ begin
 					s_disp_data <= (i_wb_data and s_wb_sel_mask) or
 										(s_disp_data and not s_wb_sel_mask);
 					s_disp_pos <= std_logic_vector(to_unsigned((to_integer(unsigned(i_wb_addr)) - ADDR_DISP) / 4, s_disp_pos'length));
+					s_disp_we <= '1';
+
+				-- LED matrix back buffer planes
+				elsif i_wb_addr >= ADDR_DISP_PLANE and i_wb_addr < ADDR_DISP_SWAP then
+					s_disp_plane_data <= i_wb_data;
+					s_disp_plane_index <= std_logic_vector(to_unsigned((to_integer(unsigned(i_wb_addr)) - ADDR_DISP_PLANE) / 4, s_disp_plane_index'length));
+					s_disp_plane_sel <= i_wb_sel;
+					s_disp_plane_we <= '1';
+
+				-- LED matrix buffer swap
+				elsif i_wb_addr = ADDR_DISP_SWAP then
+					s_disp_swap <= i_wb_data(0) and not s_wb_ack;
+
+				-- LED matrix modulation mode
+				elsif i_wb_addr = ADDR_DISP_MODE then
+					s_disp_pwm <= (i_wb_data(0) and s_wb_sel_mask(0)) or
+									  (s_disp_pwm and not s_wb_sel_mask(0));
+
+				-- LED matrix 12bit pixels, into the back buffer
+				elsif i_wb_addr >= ADDR_DISP_PWM and i_wb_addr < ADDR_DISP_PWM + 96 then
+					s_disp_pwm_data <= i_wb_data;
+					s_disp_pwm_addr <= std_logic_vector(to_unsigned((to_integer(unsigned(i_wb_addr)) - ADDR_DISP_PWM) / 4, s_disp_pwm_addr'length));
+					s_disp_pwm_sel <= i_wb_sel;
+					s_disp_pwm_we <= '1';
+
+				-- Input debounce time
+				elsif i_wb_addr = ADDR_INPUT_DEBOUNCE then
+					s_input_debounce <= (i_wb_data(15 downto 0) and s_wb_sel_mask(15 downto 0)) or
+											  (s_input_debounce and not s_wb_sel_mask(15 downto 0));
 
 				-- UART0 TX
 				elsif i_wb_addr = ADDR_UART0_TX then
-					if s_uart0_tx_active = '0' and s_uart0_tx_dv = '0' then
-						s_uart0_tx_byte <= i_wb_data(7 downto 0);
-						s_uart0_tx_dv <= '1';
-					end if;
+					s_uart0_tx_byte <= i_wb_data(7 downto 0);
+					s_uart0_tx_push <= not s_wb_ack;
 
 				-- UART1 TX
 				elsif i_wb_addr = ADDR_UART1_TX then
-					if s_uart1_tx_active = '0' and s_uart1_tx_dv = '0' then
-						s_uart1_tx_byte <= i_wb_data(7 downto 0);
-						s_uart1_tx_dv <= '1';
-					end if;
+					s_uart1_tx_byte <= i_wb_data(7 downto 0);
+					s_uart1_tx_push <= not s_wb_ack;
 
 				-- Timer reset
 				elsif i_wb_addr = ADDR_TIMER_RST then
@@ -344,6 +554,23 @@ begin
 				elsif i_wb_addr = ADDR_TIMER_INT then
 					s_timer_int <= i_wb_data and s_wb_sel_mask;
 
+				-- DMA source
+				elsif i_wb_addr = ADDR_DMA_SRC then
+					s_dma_src <= i_wb_data;
+
+				-- DMA destination
+				elsif i_wb_addr = ADDR_DMA_DST then
+					s_dma_dst <= i_wb_data;
+
+				-- DMA length
+				elsif i_wb_addr = ADDR_DMA_LEN then
+					s_dma_len <= i_wb_data;
+
+				-- DMA control, ignored while a transfer is in progress
+				elsif i_wb_addr = ADDR_DMA_CTRL then
+					s_dma_mode <= i_wb_data(2 downto 1);
+					s_dma_start <= i_wb_data(0) and not s_wb_ack and not s_dma_busy;
+
 				end if;
 			end if;
 		end if;
@@ -352,21 +579,23 @@ begin
 	wb_read : process(clk, rst_n)
 	begin
 		if(rst_n = '0') then
-			s_uart0_rx_ready <= '0';
-			s_uart1_rx_ready <= '0';
+			s_uart0_rx_pop <= '0';
+			s_uart1_rx_pop <= '0';
+			s_uart0_rx_overrun_clr <= '0';
+			s_uart1_rx_overrun_clr <= '0';
+			s_input_event_pop <= '0';
+			s_input_time <= (others => '0');
 
 			s_uart0_ndsr <= '1';
 			s_uart0_ncts <= '1';
 
 			o_wb_data <= (others => '1');
 		elsif rising_edge(clk) then
-			if s_uart0_rx_dv = '1' then
-				s_uart0_rx_ready <= '1';
-			end if;
-
-			if s_uart1_rx_dv = '1' then
-				s_uart1_rx_ready <= '1';
-			end if;
+			s_uart0_rx_pop <= '0';
+			s_uart1_rx_pop <= '0';
+			s_uart0_rx_overrun_clr <= '0';
+			s_uart1_rx_overrun_clr <= '0';
+			s_input_event_pop <= '0';
 
 			s_uart0_ndsr <= '0';
 			s_uart0_ncts <= '0';
@@ -385,7 +614,7 @@ begin
 
 				-- Buttons and switches
 				elsif i_wb_addr = ADDR_BTN_SW then
-					o_wb_data(12 downto 0) <=  i_pb & i_sw;
+					o_wb_data(12 downto 0) <=  s_btn_sw;
 					o_wb_data(31 downto 13) <= (others => '0');
 
 				-- Nanosecond runtime counter (lower half)
@@ -434,7 +663,7 @@ begin
 					if s_uart0_rx_ready = '1' then
 						o_wb_data(7 downto 0) <=  s_uart0_rx_byte;
 						o_wb_data(31 downto 8) <= (others => '0');
-						s_uart0_rx_ready <= '0';
+						s_uart0_rx_pop <= not s_wb_ack;
 					else
 						o_wb_data(31 downto 0) <= (others => '1'); -- stall
 					end if;
@@ -444,11 +673,97 @@ begin
 					if s_uart1_rx_ready = '1' then
 						o_wb_data(7 downto 0) <=  s_uart1_rx_byte;
 						o_wb_data(31 downto 8) <= (others => '0');
-						s_uart1_rx_ready <= '0';
+						s_uart1_rx_pop <= not s_wb_ack;
 					else
 						o_wb_data(31 downto 0) <= (others => '1'); -- stall
 					end if;
 
+				-- UART0 RX FIFO level
+				elsif i_wb_addr = ADDR_UART0_RX_LVL then
+					o_wb_data(c_uart_level_len - 1 downto 0) <= s_uart0_rx_level;
+					o_wb_data(30 downto c_uart_level_len) <= (others => '0');
+					o_wb_data(31) <= s_uart0_rx_overrun;
+					s_uart0_rx_overrun_clr <= not s_wb_ack;
+
+				-- UART0 TX FIFO level
+				elsif i_wb_addr = ADDR_UART0_TX_LVL then
+					o_wb_data(c_uart_level_len - 1 downto 0) <= s_uart0_tx_level;
+					o_wb_data(31 downto c_uart_level_len) <= (others => '0');
+
+				-- UART1 RX FIFO level
+				elsif i_wb_addr = ADDR_UART1_RX_LVL then
+					o_wb_data(c_uart_level_len - 1 downto 0) <= s_uart1_rx_level;
+					o_wb_data(30 downto c_uart_level_len) <= (others => '0');
+					o_wb_data(31) <= s_uart1_rx_overrun;
+					s_uart1_rx_overrun_clr <= not s_wb_ack;
+
+				-- UART1 TX FIFO level
+				elsif i_wb_addr = ADDR_UART1_TX_LVL then
+					o_wb_data(c_uart_level_len - 1 downto 0) <= s_uart1_tx_level;
+					o_wb_data(31 downto c_uart_level_len) <= (others => '0');
+
+				-- UART FIFO depth
+				elsif i_wb_addr = ADDR_UART_FIFO_SZ then
+					o_wb_data <= std_logic_vector(to_unsigned(g_UART_FIFO_DEPTH, 32));
+
+				-- LED matrix buffer swap pending
+				elsif i_wb_addr = ADDR_DISP_SWAP then
+					o_wb_data(0) <= s_disp_swap_pending;
+					o_wb_data(31 downto 1) <= (others => '0');
+
+				-- LED matrix modulation mode
+				elsif i_wb_addr = ADDR_DISP_MODE then
+					o_wb_data(0) <= s_disp_pwm;
+					o_wb_data(31 downto 1) <= (others => '0');
+
+				-- Input event, popped with its time kept for the next read
+				elsif i_wb_addr = ADDR_INPUT_EVENT then
+					o_wb_data(31) <= s_input_event_valid;
+					o_wb_data(30) <= s_input_event_overrun;
+					o_wb_data(29 downto 9) <= (others => '0');
+					o_wb_data(8) <= s_input_event(4);
+					o_wb_data(7 downto 4) <= (others => '0');
+					o_wb_data(3 downto 0) <= s_input_event(3 downto 0);
+					if s_input_event_valid = '1' and s_wb_ack = '0' then
+						s_input_time <= s_input_event(36 downto 5);
+						s_input_event_pop <= '1';
+					end if;
+
+				-- Input event time
+				elsif i_wb_addr = ADDR_INPUT_TIME then
+					o_wb_data <= s_input_time;
+
+				-- Input debounce time
+				elsif i_wb_addr = ADDR_INPUT_DEBOUNCE then
+					o_wb_data(15 downto 0) <= s_input_debounce;
+					o_wb_data(31 downto 16) <= (others => '0');
+
+				-- SDRAM cache hits
+				elsif i_wb_addr = ADDR_CACHE_HITS then
+					o_wb_data <= i_cache_hits;
+
+				-- SDRAM cache misses
+				elsif i_wb_addr = ADDR_CACHE_MISSES then
+					o_wb_data <= i_cache_misses;
+
+				-- DMA source, advanced during the transfer
+				elsif i_wb_addr = ADDR_DMA_SRC then
+					o_wb_data <= s_dma_cur_src;
+
+				-- DMA destination, advanced during the transfer
+				elsif i_wb_addr = ADDR_DMA_DST then
+					o_wb_data <= s_dma_cur_dst;
+
+				-- DMA remaining length
+				elsif i_wb_addr = ADDR_DMA_LEN then
+					o_wb_data <= s_dma_cur_len;
+
+				-- DMA mode and busy
+				elsif i_wb_addr = ADDR_DMA_CTRL then
+					o_wb_data(0) <= s_dma_busy;
+					o_wb_data(2 downto 1) <= s_dma_mode;
+					o_wb_data(31 downto 3) <= (others => '0');
+
 				-- Timer reset
 				elsif i_wb_addr = ADDR_TIMER_RST then
 					o_wb_data(s_timer_rst'length-1 downto 0) <= s_timer_rst;
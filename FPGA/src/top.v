@@ -62,6 +62,30 @@ module top (
 	wire 			s_wbm_ack_i;
 	wire 			s_wbm_cyc_o;
 
+	// DMA master interface signals
+
+	wire			s_wb_dma_cyc;
+	wire			s_wb_dma_stb;
+	wire			s_wb_dma_we;
+	wire [31:0] s_wb_dma_addr;
+	wire [31:0] s_wb_dma_data_o;
+	wire  [3:0]	s_wb_dma_sel;
+	wire			s_wb_dma_stall;
+	wire			s_wb_dma_ack;
+	wire [31:0]	s_wb_dma_data_i;
+
+	// Granted master to slave arbiter
+
+	wire			s_wb_cyc;
+	wire			s_wb_stb;
+	wire			s_wb_we;
+	wire [31:0] s_wb_addr;
+	wire [31:0] s_wb_data_o;
+	wire  [3:0]	s_wb_sel;
+	wire			s_wb_stall;
+	wire			s_wb_ack;
+	wire [31:0]	s_wb_data_i;
+
 	//  Wishbone BROM
 
 	wire			s_wb_brom_cyc;
@@ -110,6 +134,21 @@ module top (
 	wire			s_wb_sdram_ack;
 	wire [31:0]	s_wb_sdram_data_o;
 
+	// SDRAM cache to controller
+
+	wire			s_wb_ctrl_cyc;
+	wire			s_wb_ctrl_stb;
+	wire			s_wb_ctrl_we;
+	wire [21:0] s_wb_ctrl_addr;
+	wire [31:0] s_wb_ctrl_data_i;
+	wire	[3:0] s_wb_ctrl_sel;
+	wire			s_wb_ctrl_stall;
+	wire			s_wb_ctrl_ack;
+	wire [31:0]	s_wb_ctrl_data_o;
+
+	wire [31:0]	s_cache_hits;
+	wire [31:0]	s_cache_misses;
+
 	///////////
 	// SDRAM //
 	///////////
@@ -120,7 +159,7 @@ module top (
 	wire 			s_o_ram_cas_n;
 	wire 			s_o_ram_we_n;
 
-	wire 			s_o_ram_dmod;
+	wire 			s_ram_dmod;
 	wire [15:0] s_i_ram_data;
 	wire [15:0] s_o_ram_data;
 	wire [31:0] s_o_debug;
@@ -135,7 +174,7 @@ module top (
 	wire [11:0]	s_ram_addr;
 	wire [1:0]  s_ram_dqm;
 
-	assign io_ram_data 	= !s_o_ram_we_n ? s_o_ram_data : 16'bZ;
+	assign io_ram_data 	= s_ram_dmod ? s_o_ram_data : 16'bZ;
 	assign s_i_ram_data 	= io_ram_data;
 	assign o_ram_we_n		= s_o_ram_we_n;
 	assign o_ram_clk		= s_clk_sys;
@@ -167,6 +206,9 @@ module top (
 		.ENABLE_MUL			(1),
 		.ENABLE_FAST_MUL	(1),
 		.ENABLE_DIV			(1),
+		.ENABLE_COUNTERS	(1),
+		.ENABLE_COUNTERS64	(1),
+		.ENABLE_IRQ_TIMER	(1),
 		.BARREL_SHIFTER	(1),
 		.REGS_INIT_ZERO	(1),
 		.PROGADDR_RESET	(32'h 0001_0000), // BROM
@@ -206,16 +248,51 @@ module top (
 		.mem_instr			(mem_instr)
 	);
 
+	WB_master_arbiter master_arbiter (
+		.clk					(s_clk_sys),
+		.rst_n				(~s_rst_proc),
+		// CPU
+		.i_wb_cpu_cyc		(s_wbm_cyc_o),
+		.i_wb_cpu_stb		(s_wbm_stb_o),
+		.i_wb_cpu_we		(s_wbm_we_o),
+		.i_wb_cpu_addr		(s_wbm_adr_o),
+		.i_wb_cpu_data		(s_wbm_dat_o),
+		.i_wb_cpu_sel		(s_wbm_sel_o),
+		.o_wb_cpu_stall	(s_stall),
+		.o_wb_cpu_ack		(s_wbm_ack_i),
+		.o_wb_cpu_data		(s_wbm_dat_i),
+		// DMA
+		.i_wb_dma_cyc		(s_wb_dma_cyc),
+		.i_wb_dma_stb		(s_wb_dma_stb),
+		.i_wb_dma_we		(s_wb_dma_we),
+		.i_wb_dma_addr		(s_wb_dma_addr),
+		.i_wb_dma_data		(s_wb_dma_data_o),
+		.i_wb_dma_sel		(s_wb_dma_sel),
+		.o_wb_dma_stall	(s_wb_dma_stall),
+		.o_wb_dma_ack		(s_wb_dma_ack),
+		.o_wb_dma_data		(s_wb_dma_data_i),
+		// Slave arbiter
+		.o_wb_cyc			(s_wb_cyc),
+		.o_wb_stb			(s_wb_stb),
+		.o_wb_we				(s_wb_we),
+		.o_wb_addr			(s_wb_addr),
+		.o_wb_data			(s_wb_data_o),
+		.o_wb_sel			(s_wb_sel),
+		.i_wb_stall			(s_wb_stall),
+		.i_wb_ack			(s_wb_ack),
+		.i_wb_data			(s_wb_data_i)
+	);
+
 	WB_slave_arbiter arbiter (
-		.i_wb_cyc			(s_wbm_cyc_o),
-		.i_wb_stb			(s_wbm_stb_o),
-		.i_wb_we				(s_wbm_we_o),
-		.i_wb_addr			(s_wbm_adr_o),
-		.i_wb_data			(s_wbm_dat_o),
-		.i_wb_sel			(s_wbm_sel_o),
-		.o_wb_stall			(s_stall),
-		.o_wb_ack			(s_wbm_ack_i),
-		.o_wb_data			(s_wbm_dat_i),
+		.i_wb_cyc			(s_wb_cyc),
+		.i_wb_stb			(s_wb_stb),
+		.i_wb_we				(s_wb_we),
+		.i_wb_addr			(s_wb_addr),
+		.i_wb_data			(s_wb_data_o),
+		.i_wb_sel			(s_wb_sel),
+		.o_wb_stall			(s_wb_stall),
+		.o_wb_ack			(s_wb_ack),
+		.o_wb_data			(s_wb_data_i),
 		// BRAM
 		.o_wb_bram_cyc		(s_wb_bram_cyc),
 		.o_wb_bram_stb		(s_wb_bram_stb),
@@ -269,7 +346,7 @@ module top (
 		.i_wb_sel	 		(s_wb_bram_sel),
 		.o_wb_stall  		(s_wb_bram_stall),
 		.o_wb_ack	 		(s_wb_bram_ack),
-		.o_wb_data	 		(s_wb_bram_data_i),
+		.o_wb_data	 		(s_wb_bram_data_i)
 	);
 
 	MEM_BROM brom (
@@ -283,7 +360,7 @@ module top (
 		.i_wb_sel	 		(s_wb_brom_sel),
 		.o_wb_stall  		(s_wb_brom_stall),
 		.o_wb_ack	 		(s_wb_brom_ack),
-		.o_wb_data	 		(s_wb_brom_data_i),
+		.o_wb_data	 		(s_wb_brom_data_i)
 	);
 
 	Peripherals mmap (
@@ -317,13 +394,27 @@ module top (
 		.i_uart0_ndtr 		(i_serial_ndtr),
 		.i_uart1_rx 		(i_uart_rx),
 		.o_uart1_tx 		(o_uart_tx),
+		// Cache
+		.i_cache_hits		(s_cache_hits),
+		.i_cache_misses	(s_cache_misses),
+		// DMA
+		.o_wb_dma_cyc		(s_wb_dma_cyc),
+		.o_wb_dma_stb		(s_wb_dma_stb),
+		.o_wb_dma_we		(s_wb_dma_we),
+		.o_wb_dma_addr		(s_wb_dma_addr),
+		.o_wb_dma_data		(s_wb_dma_data_o),
+		.o_wb_dma_sel		(s_wb_dma_sel),
+		.i_wb_dma_stall	(s_wb_dma_stall),
+		.i_wb_dma_ack		(s_wb_dma_ack),
+		.i_wb_dma_data		(s_wb_dma_data_i),
 		// IRQ
 		.o_irq 				(s_irq),
 		.i_eoi 				(s_eoi)
 	);
 
-	wbsdram sdram_ctrl (
-		.i_clk				(s_clk_sys),
+	WB_SDRAM_Cache sdram_cache (
+		.clk					(s_clk_sys),
+		.rst_n				(~s_rst_proc),
 		.i_wb_cyc			(s_wb_sdram_cyc),
 		.i_wb_stb			(s_wb_sdram_stb),
 		.i_wb_we				(s_wb_sdram_we),
@@ -333,6 +424,30 @@ module top (
 		.o_wb_stall			(s_wb_sdram_stall),
 		.o_wb_ack			(s_wb_sdram_ack),
 		.o_wb_data			(s_wb_sdram_data_i),
+		.o_wb_sdram_cyc	(s_wb_ctrl_cyc),
+		.o_wb_sdram_stb	(s_wb_ctrl_stb),
+		.o_wb_sdram_we		(s_wb_ctrl_we),
+		.o_wb_sdram_addr	(s_wb_ctrl_addr),
+		.o_wb_sdram_data	(s_wb_ctrl_data_o),
+		.o_wb_sdram_sel	(s_wb_ctrl_sel),
+		.i_wb_sdram_stall	(s_wb_ctrl_stall),
+		.i_wb_sdram_ack	(s_wb_ctrl_ack),
+		.i_wb_sdram_data	(s_wb_ctrl_data_i),
+		.o_hits				(s_cache_hits),
+		.o_misses			(s_cache_misses)
+	);
+
+	wbsdram sdram_ctrl (
+		.i_clk				(s_clk_sys),
+		.i_wb_cyc			(s_wb_ctrl_cyc),
+		.i_wb_stb			(s_wb_ctrl_stb),
+		.i_wb_we				(s_wb_ctrl_we),
+		.i_wb_addr			(s_wb_ctrl_addr),
+		.i_wb_data			(s_wb_ctrl_data_o),
+		.i_wb_sel			(s_wb_ctrl_sel),
+		.o_wb_stall			(s_wb_ctrl_stall),
+		.o_wb_ack			(s_wb_ctrl_ack),
+		.o_wb_data			(s_wb_ctrl_data_i),
 		.o_ram_cs_n			(s_ram_cs_n),
 		.o_ram_cke			(s_ram_cke),
 		.o_ram_ras_n		(s_ram_ras_n),
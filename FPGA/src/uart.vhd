@@ -0,0 +1,228 @@
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.std_logic_unsigned.all;
+use ieee.numeric_std.all;
+use IEEE.math_real.all;
+
+entity UART_Buffered is
+	generic (
+		g_CLKS_PER_BIT : positive := 25;
+		g_FIFO_DEPTH : positive := 16;
+		g_RX_IDLE_FRAMES : positive := 4
+	);
+	port (
+		clk : in std_logic;
+		rst_n : in std_logic;
+		i_rx : in std_logic;
+		o_tx : out std_logic;
+		-- Transmit FIFO
+		i_tx_push : in std_logic;
+		i_tx_data : in std_logic_vector(7 downto 0);
+		o_tx_ready : out std_logic;
+		o_tx_level : out std_logic_vector(positive(ceil(log2(real(g_FIFO_DEPTH)))) downto 0);
+		o_tx_done : out std_logic;
+		o_tx_threshold : out std_logic;
+		-- Receive FIFO
+		i_rx_pop : in std_logic;
+		o_rx_data : out std_logic_vector(7 downto 0);
+		o_rx_ready : out std_logic;
+		o_rx_level : out std_logic_vector(positive(ceil(log2(real(g_FIFO_DEPTH)))) downto 0);
+		o_rx_dv : out std_logic;
+		o_rx_threshold : out std_logic;
+		o_rx_idle : out std_logic;
+		i_rx_overrun_clr : in std_logic;
+		o_rx_overrun : out std_logic
+	);
+end UART_Buffered;
+
+architecture Behavioral of UART_Buffered is
+
+	constant c_level_len : positive := positive(ceil(log2(real(g_FIFO_DEPTH)))) + 1;
+	constant c_rx_idle_clks : positive := g_RX_IDLE_FRAMES * 10 * g_CLKS_PER_BIT;
+
+	signal s_rx_dv : std_logic;
+	signal s_rx_byte : std_logic_vector(7 downto 0);
+	signal s_rx_empty : std_logic;
+	signal s_rx_full : std_logic;
+	signal s_rx_level : std_logic_vector(c_level_len - 1 downto 0);
+	signal s_rx_half : std_logic;
+	signal s_rx_half_q : std_logic;
+	signal s_rx_overrun : std_logic;
+	signal s_rx_idle : std_logic;
+	signal s_rx_idle_cnt : natural range 0 to c_rx_idle_clks;
+
+	signal s_tx_dv : std_logic;
+	signal s_tx_byte : std_logic_vector(7 downto 0);
+	signal s_tx_active : std_logic;
+	signal s_tx_done : std_logic;
+	signal s_tx_busy : std_logic;
+	signal s_tx_pop : std_logic;
+	signal s_tx_data : std_logic_vector(7 downto 0);
+	signal s_tx_empty : std_logic;
+	signal s_tx_full : std_logic;
+	signal s_tx_level : std_logic_vector(c_level_len - 1 downto 0);
+	signal s_tx_low : std_logic;
+	signal s_tx_low_q : std_logic;
+
+begin
+
+	----------------
+	-- Components --
+	----------------
+
+	uart_rx : entity work.UART_RX
+		generic map (
+			g_CLKS_PER_BIT => g_CLKS_PER_BIT
+		)
+		port map (
+			i_Clk       => clk,
+			i_RX_Serial => i_rx,
+			o_RX_DV     => s_rx_dv,
+			o_RX_Byte   => s_rx_byte
+		);
+
+	uart_tx : entity work.UART_TX
+		generic map (
+			g_CLKS_PER_BIT => g_CLKS_PER_BIT
+		)
+		port map (
+			i_Clk       => clk,
+			i_TX_DV     => s_tx_dv,
+			i_TX_Byte   => s_tx_byte,
+			o_TX_Active => s_tx_active,
+			o_TX_Serial => o_tx,
+			o_TX_Done   => s_tx_done
+		);
+
+	rx_fifo : entity work.FIFO
+		generic map (
+			g_WIDTH => 8,
+			g_DEPTH => g_FIFO_DEPTH
+		)
+		port map (
+			clk 		=> clk,
+			rst_n 	=> rst_n,
+			i_push 	=> s_rx_dv,
+			i_data 	=> s_rx_byte,
+			i_pop 	=> i_rx_pop,
+			o_data 	=> o_rx_data,
+			o_empty 	=> s_rx_empty,
+			o_full 	=> s_rx_full,
+			o_level 	=> s_rx_level
+		);
+
+	tx_fifo : entity work.FIFO
+		generic map (
+			g_WIDTH => 8,
+			g_DEPTH => g_FIFO_DEPTH
+		)
+		port map (
+			clk 		=> clk,
+			rst_n 	=> rst_n,
+			i_push 	=> i_tx_push,
+			i_data 	=> i_tx_data,
+			i_pop 	=> s_tx_pop,
+			o_data 	=> s_tx_data,
+			o_empty 	=> s_tx_empty,
+			o_full 	=> s_tx_full,
+			o_level 	=> s_tx_level
+		);
+
+	o_rx_ready <= not s_rx_empty;
+	o_rx_level <= s_rx_level;
+	o_rx_dv <= s_rx_dv;
+	o_rx_overrun <= s_rx_overrun;
+	o_rx_idle <= s_rx_idle;
+
+	o_tx_ready <= not s_tx_full;
+	o_tx_level <= s_tx_level;
+	o_tx_done <= s_tx_done;
+
+	----------------
+	-- Thresholds --
+	----------------
+
+	s_rx_half <= '1' when s_rx_level >= g_FIFO_DEPTH / 2 else '0';
+	s_tx_low <= '1' when s_tx_level <= g_FIFO_DEPTH / 4 else '0';
+
+	o_rx_threshold <= s_rx_half and not s_rx_half_q;
+	o_tx_threshold <= s_tx_low and not s_tx_low_q;
+
+	thresholds : process(clk, rst_n)
+	begin
+		if rst_n = '0' then
+			s_rx_half_q <= '0';
+			s_tx_low_q <= '1';
+		elsif rising_edge(clk) then
+			s_rx_half_q <= s_rx_half;
+			s_tx_low_q <= s_tx_low;
+		end if;
+	end process;
+
+	-------------
+	-- Receive --
+	-------------
+
+	rx_overrun : process(clk, rst_n)
+	begin
+		if rst_n = '0' then
+			s_rx_overrun <= '0';
+		elsif rising_edge(clk) then
+			if s_rx_dv = '1' and s_rx_full = '1' then
+				s_rx_overrun <= '1';
+			elsif i_rx_overrun_clr = '1' then
+				s_rx_overrun <= '0';
+			end if;
+		end if;
+	end process;
+
+	-- Bytes left below the threshold are reported once, after the line has
+	-- been quiet for g_RX_IDLE_FRAMES frames since the last one arrived.
+	rx_idle : process(clk, rst_n)
+	begin
+		if rst_n = '0' then
+			s_rx_idle <= '0';
+			s_rx_idle_cnt <= 0;
+		elsif rising_edge(clk) then
+			s_rx_idle <= '0';
+			if s_rx_dv = '1' then
+				s_rx_idle_cnt <= c_rx_idle_clks;
+			elsif s_rx_idle_cnt /= 0 then
+				s_rx_idle_cnt <= s_rx_idle_cnt - 1;
+				if s_rx_idle_cnt = 1 and s_rx_empty = '0' then
+					s_rx_idle <= '1';
+				end if;
+			end if;
+		end if;
+	end process;
+
+	--------------
+	-- Transmit --
+	--------------
+
+	-- UART_TX only samples i_TX_DV while idle, which is the cycle after it
+	-- reports done with o_TX_Active already low.
+	tx_feed : process(clk, rst_n)
+	begin
+		if rst_n = '0' then
+			s_tx_dv <= '0';
+			s_tx_pop <= '0';
+			s_tx_busy <= '0';
+			s_tx_byte <= (others => '0');
+		elsif rising_edge(clk) then
+			s_tx_dv <= '0';
+			s_tx_pop <= '0';
+			if s_tx_busy = '0' then
+				if s_tx_empty = '0' and s_tx_pop = '0' then
+					s_tx_byte <= s_tx_data;
+					s_tx_dv <= '1';
+					s_tx_pop <= '1';
+					s_tx_busy <= '1';
+				end if;
+			elsif s_tx_done = '1' and s_tx_active = '0' then
+				s_tx_busy <= '0';
+			end if;
+		end if;
+	end process;
+
+end Behavioral;
@@ -131,3 +131,87 @@ begin
 	o_wb_sdram_sel <= i_wb_sel when s_slave = SDRAM else (others => '0');
 
 end architecture;
+
+library ieee;
+use ieee.std_logic_1164.all;
+
+-- Shares the bus between the CPU and the DMA controller. Ownership only
+-- changes while the current owner has no cycle in progress, and passes to
+-- the other master whenever it is waiting, so both masters alternate
+-- accesses when they compete for the bus.
+
+entity WB_master_arbiter is
+  port (
+	 clk					: in	std_logic;
+	 rst_n				: in	std_logic;
+	 -- CPU
+	 i_wb_cpu_cyc		: in	std_logic;
+	 i_wb_cpu_stb		: in	std_logic;
+	 i_wb_cpu_we		: in	std_logic;
+	 i_wb_cpu_addr		: in	std_logic_vector(31 downto 0);
+	 i_wb_cpu_data		: in	std_logic_vector(31 downto 0);
+	 i_wb_cpu_sel		: in	std_logic_vector( 3 downto 0);
+	 o_wb_cpu_stall	: out std_logic;
+	 o_wb_cpu_ack		: out std_logic;
+	 o_wb_cpu_data		: out std_logic_vector(31 downto 0);
+	 -- DMA
+	 i_wb_dma_cyc		: in	std_logic;
+	 i_wb_dma_stb		: in	std_logic;
+	 i_wb_dma_we		: in	std_logic;
+	 i_wb_dma_addr		: in	std_logic_vector(31 downto 0);
+	 i_wb_dma_data		: in	std_logic_vector(31 downto 0);
+	 i_wb_dma_sel		: in	std_logic_vector( 3 downto 0);
+	 o_wb_dma_stall	: out std_logic;
+	 o_wb_dma_ack		: out std_logic;
+	 o_wb_dma_data		: out std_logic_vector(31 downto 0);
+	 -- Slave arbiter
+	 o_wb_cyc			: out std_logic;
+	 o_wb_stb			: out std_logic;
+	 o_wb_we				: out std_logic;
+	 o_wb_addr			: out std_logic_vector(31 downto 0);
+	 o_wb_data			: out std_logic_vector(31 downto 0);
+	 o_wb_sel			: out std_logic_vector( 3 downto 0);
+	 i_wb_stall			: in	std_logic;
+	 i_wb_ack			: in	std_logic;
+	 i_wb_data			: in	std_logic_vector(31 downto 0)
+    );
+end entity;
+
+architecture rtl of WB_master_arbiter is
+
+	type t_master is (CPU, DMA);
+	signal s_grant : t_master;
+
+begin
+
+	grant : process(clk, rst_n)
+	begin
+		if rst_n = '0' then
+			s_grant <= CPU;
+		elsif rising_edge(clk) then
+			if s_grant = CPU and i_wb_cpu_cyc = '0' and i_wb_dma_cyc = '1' then
+				s_grant <= DMA;
+			elsif s_grant = DMA and i_wb_dma_cyc = '0' and i_wb_cpu_cyc = '1' then
+				s_grant <= CPU;
+			end if;
+		end if;
+	end process;
+
+	-- Master to slave outputs --
+	o_wb_cyc <= i_wb_dma_cyc when s_grant = DMA else i_wb_cpu_cyc;
+	o_wb_stb <= i_wb_dma_stb when s_grant = DMA else i_wb_cpu_stb;
+	o_wb_we <= i_wb_dma_we when s_grant = DMA else i_wb_cpu_we;
+	o_wb_addr <= i_wb_dma_addr when s_grant = DMA else i_wb_cpu_addr;
+	o_wb_data <= i_wb_dma_data when s_grant = DMA else i_wb_cpu_data;
+	o_wb_sel <= i_wb_dma_sel when s_grant = DMA else i_wb_cpu_sel;
+
+	-- Slave to master outputs --
+	o_wb_cpu_stall <= i_wb_stall when s_grant = CPU else '1';
+	o_wb_cpu_ack <= i_wb_ack when s_grant = CPU else '0';
+	o_wb_cpu_data <= i_wb_data;
+
+	o_wb_dma_stall <= i_wb_stall when s_grant = DMA else '1';
+	o_wb_dma_ack <= i_wb_ack when s_grant = DMA else '0';
+	o_wb_dma_data <= i_wb_data;
+
+end architecture;
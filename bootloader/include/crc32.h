@@ -0,0 +1,17 @@
+#pragma once
+
+#include <types.h>
+
+/* CRC-32 as used by zlib, table driven for the 2 Mbaud receive loop */
+
+/* Left in the register after the data and its little-endian CRC */
+#define CRC32_RESIDUE 0xDEBB20E3
+
+extern u32 crc32_table[256];
+
+void crc32_init(void);
+u32 crc32(const volatile u8 *const data, const usize length);
+
+static inline u32 crc32_update(const u32 crc, const u8 byte) {
+  return (crc >> 8) ^ crc32_table[(crc ^ byte) & 0xFF];
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <types.h>
+
+/* Compressed image: LZ4_IMAGE_MAGIC, u32 decompressed size, LZ4 block
+ *
+ * The block is decoded one byte at a time as pages arrive, straight into the
+ * firmware region. Matches are limited to LZ4_MAX_MATCH bytes by the
+ * compressor, so that copying one never overflows the UART RX FIFO.
+ */
+
+#define LZ4_IMAGE_MAGIC 0x49345A4C // "LZ4I"
+#define LZ4_MAX_MATCH 1024
+
+void lz4_start(void);
+void lz4_feed(const u8 byte);
+bool lz4_done(void);
@@ -15,6 +15,11 @@ extern void __exit(void);
 #define SIGNATURE_1 0x95
 #define SIGNATURE_2 0x0F
 
+/* Page CRCs for delta uploads, advertised through STK_GET_PARAMETER */
+#define STK_READ_PAGE_CRC 0x7A // 'z', unused by AVRDUDE
+#define STK_PARAM_PAGE_CRC 0x9E
+#define PAGE_CRC_VERSION 1
+
 /* Debug */
 #define LED_FLASH_COUNT_START 2
 #define LED_FLASH_COUNT_DONE 3
@@ -26,4 +31,6 @@ extern void __exit(void);
 
 #define TIMEOUT_MS 250
 
+u32 millis(void);
+void exit_optiboot(void);
 void optiboot(void);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <types.h>
+
+/* Streaming upload over UART1, negotiated with STK_SET_PARAMETER
+ *
+ * Frame:  STREAM_SYNC, u16 seq, u16 length, data[length], u32 crc
+ * Reply:  STREAM_ACK or STREAM_NAK, u16 next expected seq
+ *
+ * Block seq is written at seq * STREAM_BLOCK_SIZE in the firmware region, and
+ * the CRC32 covers seq, length and data. An empty block ends the upload.
+ * Blocks are acknowledged in batches of STREAM_ACK_BATCH, so the host may
+ * keep up to STREAM_WINDOW blocks in flight. After a NAK the bootloader
+ * drops input until the line is silent, and the host resends from seq.
+ */
+
+#define STK_PARAM_STREAM 0x9F // unused by AVRDUDE
+#define STREAM_VERSION 1
+
+#define STREAM_SYNC 0xA5
+#define STREAM_ACK 0x06
+#define STREAM_NAK 0x15
+
+#define STREAM_BLOCK_SIZE 1024
+#define STREAM_WINDOW 8
+#define STREAM_ACK_BATCH 4
+
+#define STREAM_TIMEOUT_MS 500
+#define STREAM_RESYNC_MS 20
+
+void stream_upload(void);
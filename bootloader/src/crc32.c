@@ -0,0 +1,21 @@
+#include <crc32.h>
+
+u32 crc32_table[256];
+
+void crc32_init(void) {
+  for (u32 i = 0; i < 256; ++i) {
+    u32 crc = i;
+    for (usize bit = 0; bit < 8; ++bit) {
+      crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    }
+    crc32_table[i] = crc;
+  }
+}
+
+u32 crc32(const volatile u8 *const data, const usize length) {
+  u32 crc = 0xFFFFFFFF;
+  for (usize i = 0; i < length; ++i) {
+    crc = crc32_update(crc, data[i]);
+  }
+  return ~crc;
+}
@@ -0,0 +1,94 @@
+#include <lz4.h>
+#include <memory.h>
+
+enum LZ4_STATE {
+  LZ4_SIZE,
+  LZ4_TOKEN,
+  LZ4_LITERAL_LENGTH,
+  LZ4_LITERALS,
+  LZ4_OFFSET_LOW,
+  LZ4_OFFSET_HIGH,
+  LZ4_MATCH_LENGTH,
+  LZ4_DONE,
+};
+
+static u8 state;
+static u8 token;
+static usize length;
+static usize offset;
+static volatile u8 *out;
+static volatile u8 *end;
+
+void lz4_start(void) {
+  state = LZ4_SIZE;
+  length = 0;
+  offset = 0;
+  out = (u8 *)&__fw_start;
+}
+
+bool lz4_done(void) { return state == LZ4_DONE; }
+
+static void copy_match(void) {
+  length += 4;
+  if (offset == 0 || out - offset < (u8 *)&__fw_start || out + length > end) {
+    state = LZ4_DONE;
+    return;
+  }
+  const volatile u8 *from = out - offset;
+  while (length--) {
+    *out++ = *from++;
+  }
+  state = out < end ? LZ4_TOKEN : LZ4_DONE;
+}
+
+void lz4_feed(const u8 byte) {
+  switch (state) {
+  case LZ4_SIZE:
+    offset |= (usize)byte << (8 * length);
+    if (++length == sizeof(u32)) {
+      end = out + offset;
+      state = offset == 0 || end > (u8 *)&__fw_end ? LZ4_DONE : LZ4_TOKEN;
+    }
+    break;
+  case LZ4_TOKEN:
+    token = byte;
+    length = byte >> 4;
+    state = length == 15 ? LZ4_LITERAL_LENGTH
+            : length     ? LZ4_LITERALS
+                         : LZ4_OFFSET_LOW;
+    break;
+  case LZ4_LITERAL_LENGTH:
+    length += byte;
+    if (byte != 255) {
+      state = LZ4_LITERALS;
+    }
+    break;
+  case LZ4_LITERALS:
+    *out++ = byte;
+    if (out == end) {
+      state = LZ4_DONE;
+    } else if (--length == 0) {
+      state = LZ4_OFFSET_LOW;
+    }
+    break;
+  case LZ4_OFFSET_LOW:
+    offset = byte;
+    state = LZ4_OFFSET_HIGH;
+    break;
+  case LZ4_OFFSET_HIGH:
+    offset |= byte << 8;
+    length = token & 0xF;
+    if (length == 15) {
+      state = LZ4_MATCH_LENGTH;
+    } else {
+      copy_match();
+    }
+    break;
+  case LZ4_MATCH_LENGTH:
+    length += byte;
+    if (byte != 255) {
+      copy_match();
+    }
+    break;
+  }
+}
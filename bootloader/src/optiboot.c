@@ -1,16 +1,23 @@
+#include <crc32.h>
+#include <lz4.h>
 #include <memory.h>
 #include <optiboot.h>
+#include <stream.h>
 
-static u64 time_start_millis;
+static u32 time_start_millis;
 static bool timeout_enabled;
+static bool decompressing;
+static u8 address_ext;
 
-void sleep(const u64 interval_ms) {
-  const u64 start = __counter_millis;
-  while (__counter_millis - start < interval_ms)
+u32 millis(void) { return *(volatile u32 *)&__counter_millis; }
+
+static void sleep(const u32 interval_ms) {
+  const u32 start = millis();
+  while (millis() - start < interval_ms)
     ;
 }
 
-void flash_led(const usize count) {
+static void flash_led(const usize count) {
   for (usize i = 0; i < count; ++i) {
     __gpio_led_sem = 1;
     sleep(LED_FLASH_INTERVAL);
@@ -25,7 +32,7 @@ void exit_optiboot(void) {
   __exit();
 }
 
-void put_ch(const char character) {
+static void put_ch(const char character) {
   while (!__uart0_tx_ready)
     ;
   __uart0_tx = character;
@@ -33,7 +40,7 @@ void put_ch(const char character) {
 
 #ifdef DEBUG_OVER_UART1
 
-void put_dbg(const char *const buffer) {
+static void put_dbg(const char *const buffer) {
   char *character = (char *)buffer;
   while (*character != '\0') {
     while (!__uart1_tx_ready)
@@ -43,7 +50,7 @@ void put_dbg(const char *const buffer) {
   }
 }
 
-void put_dbg_num(const usize number, const usize base) {
+static void put_dbg_num(const usize number, const usize base) {
   char buffer[32];
   usize n = number;
   usize d = 0;
@@ -78,12 +85,12 @@ void put_dbg_num(const usize number, const usize base) {
 
 #endif
 
-char get_ch(void) {
+static char get_ch(void) {
   while (!__uart0_rx_ready) {
-    if (timeout_enabled && __counter_millis - time_start_millis >= TIMEOUT_MS) {
+    if (timeout_enabled && millis() - time_start_millis >= TIMEOUT_MS) {
 #ifdef DEBUG_OVER_UART1
       put_dbg("\nOptiboot timeout at ");
-      put_dbg_num((usize)__counter_millis, 10);
+      put_dbg_num(millis(), 10);
       put_dbg(" ms.\n");
 #endif
       exit_optiboot();
@@ -93,28 +100,28 @@ char get_ch(void) {
   return __uart0_rx;
 }
 
-u8 get_length(void) {
-  u8 length;
+static u16 get_length(void) {
+  u16 length;
   length = get_ch() << 8;
   length |= get_ch();
   return length;
 }
 
-void verify_space(void) {
+static void verify_space(void) {
   if (get_ch() != CRC_EOP) {
     sleep(16);
   }
   put_ch(STK_INSYNC);
 }
 
-void get_n_ch(const usize count) {
+static void get_n_ch(const usize count) {
   for (usize i = 0; i < count; ++i) {
     get_ch();
   }
   verify_space();
 }
 
-void stk_get_parameter(void) {
+static void stk_get_parameter(void) {
   unsigned char which = get_ch();
   verify_space();
   usize version =
@@ -123,12 +130,25 @@ void stk_get_parameter(void) {
     put_ch(version & 0xFF);
   } else if (which == STK_SW_MAJOR) {
     put_ch(version >> 8);
+  } else if (which == STK_PARAM_PAGE_CRC) {
+    put_ch(PAGE_CRC_VERSION);
+#ifndef DEBUG_OVER_UART1
+  } else if (which == STK_PARAM_STREAM) {
+    put_ch(STREAM_VERSION);
+#endif
   } else {
     put_ch(0x03);
   }
 }
 
-void stk_load_address(u16 *const address) {
+static bool stk_set_parameter(void) {
+  const u8 which = get_ch();
+  const u8 value = get_ch();
+  verify_space();
+  return which == STK_PARAM_STREAM && value == STREAM_VERSION;
+}
+
+static void stk_load_address(u16 *const address) {
   u16 lo, hi;
   lo = get_ch();
   hi = get_ch() << 8;
@@ -136,25 +156,57 @@ void stk_load_address(u16 *const address) {
   verify_space();
 }
 
-void stk_univeral(void) {
-  get_n_ch(4);
+static void stk_univeral(void) {
+  if (get_ch() == AVR_OP_LOAD_EXT_ADDR) {
+    get_ch();
+    address_ext = get_ch();
+    get_n_ch(1);
+  } else {
+    get_n_ch(3);
+  }
   put_ch(0x00);
 }
 
-void stk_prog_page(const u16 address) {
-  const usize page_start = address << 1;
+/* AVRDUDE loads word addresses, with the bits above 128 KiB set through
+ * the universal LOAD_EXT_ADDR command for parts with larger flash */
+static usize page_address(const u16 address) {
+  return ((usize)address_ext << 16 | address) << 1;
+}
+
+/* Firmware may be placed in the BRAM window and in SDRAM, anything else
+ * would overwrite the bootloader's stack or the peripherals */
+static bool fw_address_valid(const usize offset) {
+  const usize address = (usize)&__fw_start + offset;
+  return (address >= (usize)&__fw_start && address < (usize)&__fw_end) ||
+         (address >= (usize)&__sdram_start && address < (usize)&__sdram_end);
+}
+
+static void stk_prog_page(const u16 address) {
+  const usize page_start = page_address(address);
 #ifdef DEBUG_OVER_UART1
   put_dbg("Page start: ");
   put_dbg_num(page_start, 16);
   put_dbg("\n");
 #endif
-  u8 length = get_length();
+  u16 length = get_length();
   get_ch(); // desttype
   volatile char *const bram = (char *)&__fw_start;
   for (usize byte = 0; byte < length; ++byte) {
     const usize offset = page_start + byte;
     const u8 value = get_ch();
-    *(bram + offset) = value;
+    if (decompressing && offset >= sizeof(u32)) {
+      lz4_feed(value);
+    } else if (fw_address_valid(offset)) {
+      *(bram + offset) = value;
+    }
+    // Compressed images are recognized by the first word of the first page,
+    // which the decoder overwrites afterwards
+    if (offset == sizeof(u32) - 1) {
+      decompressing = *(volatile u32 *)bram == LZ4_IMAGE_MAGIC;
+      if (decompressing) {
+        lz4_start();
+      }
+    }
 #ifdef DEBUG_OVER_UART1
     put_dbg_num(value, 16);
     if (byte > 0 && byte % 4 == 3) {
@@ -167,19 +219,39 @@ void stk_prog_page(const u16 address) {
   verify_space();
 }
 
-void stk_read_page(const u16 address) {
-  u8 length = get_length();
+static void stk_read_page(const u16 address) {
+  u16 length = get_length();
   get_ch(); // desttype
   verify_space();
   const volatile char *const bram = (char *)&__fw_start;
-  const usize page_start = address << 1;
+  const usize page_start = page_address(address);
   for (usize byte = 0; byte < length; ++byte) {
     const usize offset = page_start + byte;
-    put_ch(*(bram + offset));
+    put_ch(fw_address_valid(offset) ? *(bram + offset) : 0xFF);
   }
 }
 
-void stk_read_sign(void) {
+/* CRC32 of each page of the firmware region, the last one may be shorter */
+static void stk_read_page_crc(void) {
+  const u16 page_size = get_length();
+  verify_space();
+  if (page_size == 0) {
+    return;
+  }
+  crc32_init();
+  const volatile u8 *const bram = (u8 *)&__fw_start;
+  const usize fw_size = (usize)&__fw_end - (usize)&__fw_start;
+  for (usize start = 0; start < fw_size; start += page_size) {
+    const usize length =
+        fw_size - start < page_size ? fw_size - start : page_size;
+    const u32 crc = crc32(bram + start, length);
+    for (usize byte = 0; byte < sizeof(crc); ++byte) {
+      put_ch(crc >> (8 * byte));
+    }
+  }
+}
+
+static void stk_read_sign(void) {
   verify_space();
   put_ch(SIGNATURE_0);
   put_ch(SIGNATURE_1);
@@ -189,20 +261,30 @@ void stk_read_sign(void) {
 void optiboot(void) {
   __gpio_7segm = HEX_BOOT;
   flash_led(LED_FLASH_COUNT_START);
-  time_start_millis = __counter_millis;
+  time_start_millis = millis();
   timeout_enabled = true;
+  // BRAM is not cleared on reset, so neither is the previous session's state
+  decompressing = false;
+  address_ext = 0;
 #ifdef DEBUG_OVER_UART1
   put_dbg("\n\nOptiboot started at ");
-  put_dbg_num((usize)__counter_millis, 10);
+  put_dbg_num(millis(), 10);
   put_dbg(" ms.\n");
 #endif
   u16 address;
+  bool streaming = false;
   for (;;) {
     switch (get_ch()) {
     case STK_GET_PARAMETER:
       stk_get_parameter();
 #ifdef DEBUG_OVER_UART1
       put_dbg("STK_GET_PARAMETER\n");
+#endif
+      break;
+    case STK_SET_PARAMETER:
+      streaming = stk_set_parameter();
+#ifdef DEBUG_OVER_UART1
+      put_dbg("STK_SET_PARAMETER\n");
 #endif
       break;
     case STK_SET_DEVICE:
@@ -253,6 +335,12 @@ void optiboot(void) {
       put_dbg("STK_READ_PAGE ");
       put_dbg_num(address, 16);
       put_dbg("\n");
+#endif
+      break;
+    case STK_READ_PAGE_CRC:
+      stk_read_page_crc();
+#ifdef DEBUG_OVER_UART1
+      put_dbg("STK_READ_PAGE_CRC\n");
 #endif
       break;
     case STK_READ_SIGN:
@@ -268,5 +356,9 @@ void optiboot(void) {
 #endif
     }
     put_ch(STK_OK);
+    if (streaming) {
+      streaming = false;
+      stream_upload();
+    }
   }
 }
@@ -0,0 +1,101 @@
+#include <crc32.h>
+#include <memory.h>
+#include <optiboot.h>
+#include <stddef.h>
+#include <stream.h>
+
+/* A word read pops the RX FIFO, and returns all ones when it is empty */
+static inline u32 uart1_rx(void) {
+  return *(const volatile u32 *)&__uart1_rx;
+}
+
+static i32 get_byte(const u32 timeout_ms) {
+  const u32 start = millis();
+  for (;;) {
+    const u32 byte = uart1_rx();
+    if (byte <= 0xFF) {
+      return byte;
+    }
+    if (millis() - start >= timeout_ms) {
+      return -1;
+    }
+  }
+}
+
+static void put_byte(const u8 byte) {
+  while (!__uart1_tx_ready)
+    ;
+  __uart1_tx = byte;
+}
+
+static void reply(const u8 status, const u16 seq) {
+  put_byte(status);
+  put_byte(seq & 0xFF);
+  put_byte(seq >> 8);
+}
+
+/* Receives count bytes into the CRC, and stores them if data is given */
+static bool get_bytes(volatile u8 *const data, const usize count,
+                      u32 *const crc) {
+  for (usize i = 0; i < count; ++i) {
+    const i32 byte = get_byte(STREAM_TIMEOUT_MS);
+    if (byte < 0) {
+      return false;
+    }
+    *crc = crc32_update(*crc, byte);
+    if (data) {
+      data[i] = byte;
+    }
+  }
+  return true;
+}
+
+static void resync(void) {
+  while (get_byte(STREAM_RESYNC_MS) >= 0)
+    ;
+}
+
+/* Returns on a timeout, or leaves the bootloader after the last block */
+void stream_upload(void) {
+  crc32_init();
+  volatile u8 *const bram = (u8 *)&__fw_start;
+  const usize fw_size = (usize)&__fw_end - (usize)&__fw_start;
+  u16 expected = 0;
+  usize batch = 0;
+  for (;;) {
+    const i32 sync = get_byte(STREAM_TIMEOUT_MS);
+    if (sync < 0) {
+      return;
+    } else if (sync != STREAM_SYNC) {
+      continue;
+    }
+    u32 crc = 0xFFFFFFFF;
+    u8 header[4];
+    if (!get_bytes(header, sizeof(header), &crc)) {
+      return;
+    }
+    const u16 seq = header[0] | header[1] << 8;
+    const usize length = header[2] | header[3] << 8;
+    const usize offset = seq * STREAM_BLOCK_SIZE;
+    const bool valid = seq == expected && length <= STREAM_BLOCK_SIZE &&
+                       offset + length <= fw_size;
+    // Running the CRC over its own value leaves a constant residue
+    if (valid && (!get_bytes(bram + offset, length, &crc) ||
+                  !get_bytes(NULL, sizeof(u32), &crc))) {
+      return;
+    }
+    if (!valid || crc != CRC32_RESIDUE) {
+      resync();
+      reply(STREAM_NAK, expected);
+      continue;
+    }
+    ++expected;
+    if (length == 0 || ++batch == STREAM_ACK_BATCH) {
+      batch = 0;
+      reply(STREAM_ACK, expected);
+    }
+    if (length == 0) {
+      exit_optiboot();
+    }
+  }
+}
@@ -13,19 +13,19 @@ build/%.c.o: ./src/%.c
 	mkdir -p "$$(dirname $@)"
 	${TOOLCHAIN}gcc \
 		-std=c2x -Wall -ffreestanding -g -Os -I include -march=${RV32_ARCH} \
-		$^ -c -o $@
+		${DEFINES} $^ -c -o $@
 
 build/%.cpp.o: ./src/%.cpp
 	mkdir -p "$$(dirname $@)"
 	${TOOLCHAIN}gcc \
 		-std=c++2b -Wall -ffreestanding -g -Os -I include -march=${RV32_ARCH} \
-		$^ -c -o $@
+		${DEFINES} $^ -c -o $@
 
 build/%.S.o: ./src/%.S
 	mkdir -p "$$(dirname $@)"
 	${TOOLCHAIN}gcc \
 		-Wall -ffreestanding -g -Os -I include -march=${RV32_ARCH} \
-		$^ -c -o $@
+		${DEFINES} $^ -c -o $@
 
 build/%.elf: ./${LINKER_SCRIPT} \
 	$(shell find ${CURDIR}/src -type f \( -name '*.c' -o -name '*.cpp' -o -name '*.S' \) -printf 'build/%P.o\n')
@@ -45,6 +45,7 @@ else
 		-Wl,-Bdynamic $(shell echo $^ | cut -d ' ' -f 2-) \
 		-o $@
 endif
+	cp -f $@ $(@:.elf=.debug.elf)
 	${TOOLCHAIN}strip $@
 
 build/%.bin: build/%.elf
@@ -56,6 +57,9 @@ build/%.lst: build/%.elf
 build/%.intel.hex: build/%.elf
 	${TOOLCHAIN}objcopy -O ihex $^ $@
 
+build/%.lz.hex: build/%.intel.hex
+	python3 ${COMMON_DIR}/scripts/lz_image.py $^ $@
+
 build/%.plain.hex: build/%.elf
 	${E2X_TOOLCHAIN}/bin/${RV32_TARGET}-elf2hex \
 		--bit-width 32 \
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""Firmware upload that only rewrites pages differing from the BRAM contents.
+
+Usage: delta_upload.py build/firmware.intel.hex UART0 [page size]
+
+BRAM keeps its contents across a reset, so the bootloader is asked for the
+CRC32 of every page, and only mismatching pages are written over STK500.
+The last page of the image is always written, since the bytes after the end
+of the image are unknown on the host.
+"""
+
+import struct
+import sys
+import time
+import zlib
+
+from stream_upload import (FW_SIZE, STK_GET_PARAMETER, enter_bootloader,
+                           open_port, read_hex, stk)
+
+STK_LEAVE_PROGMODE = 0x51
+STK_LOAD_ADDRESS = 0x55
+STK_PROG_PAGE = 0x64
+STK_READ_PAGE_CRC = 0x7A
+STK_PARAM_PAGE_CRC = 0x9E
+PAGE_CRC_VERSION = 1
+
+PAGE_SIZE = 256
+
+
+def read_page_crcs(fd, page_size):
+    count = (FW_SIZE + page_size - 1) // page_size
+    reply = stk(fd, [STK_READ_PAGE_CRC, page_size >> 8, page_size & 0xFF],
+                4 * count)
+    return struct.unpack(f"<{count}I", reply)
+
+
+def changed_pages(image, crcs, page_size):
+    return [
+        start
+        for index, start in enumerate(range(0, len(image), page_size))
+        if zlib.crc32(image[start:start + page_size]) != crcs[index]
+    ]
+
+
+def write_page(fd, start, page):
+    address = start >> 1
+    stk(fd, [STK_LOAD_ADDRESS, address & 0xFF, address >> 8])
+    stk(fd, [STK_PROG_PAGE, len(page) >> 8, len(page) & 0xFF, ord("F")] +
+        list(page))
+
+
+def main():
+    if len(sys.argv) not in (3, 4):
+        sys.exit(__doc__.strip())
+    image = read_hex(sys.argv[1])
+    page_size = int(sys.argv[3], 0) if len(sys.argv) == 4 else PAGE_SIZE
+    uart0 = open_port(sys.argv[2], 115200)
+
+    started = time.monotonic()
+    enter_bootloader(uart0)
+    version = stk(uart0, [STK_GET_PARAMETER, STK_PARAM_PAGE_CRC], 1)[0]
+    if version != PAGE_CRC_VERSION:
+        sys.exit("bootloader does not support page CRCs, use avrdude")
+    pages = changed_pages(image, read_page_crcs(uart0, page_size), page_size)
+    for start in pages:
+        write_page(uart0, start, image[start:start + page_size])
+    crcs = read_page_crcs(uart0, page_size)
+    if any(start + page_size <= len(image)
+           for start in changed_pages(image, crcs, page_size)):
+        sys.exit("verification failed, BRAM does not match the image")
+    stk(uart0, [STK_LEAVE_PROGMODE])
+
+    total = (len(image) + page_size - 1) // page_size
+    print(f"{len(pages)} of {total} pages written "
+          f"in {time.monotonic() - started:.3f} s")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,30 @@
+function hex(digits,    i, digit, value) {
+    value = 0;
+    for (i = 1; i <= length(digits); ++i) {
+        digit = index("0123456789ABCDEF", toupper(substr(digits, i, 1))) - 1;
+        value = value * 16 + digit;
+    }
+    return value;
+}
+BEGIN {
+    base = 0;
+    end = 0;
+}
+/^:/ {
+    byte_count = hex(substr($0, 2, 2));
+    address = hex(substr($0, 4, 4));
+    record_type = hex(substr($0, 8, 2));
+
+    # Extended segment and linear address records set the upper bits
+    if (record_type == 2) {
+        base = hex(substr($0, 10, 4)) * 16;
+    } else if (record_type == 4) {
+        base = hex(substr($0, 10, 4)) * 65536;
+    } else if (record_type == 0 && base + address + byte_count > end) {
+        end = base + address + byte_count;
+    }
+}
+END {
+    # First address past the data
+    printf "%d\n", end;
+}
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""Compressed firmware image for the bootloader's LZ4 decoder.
+
+Usage: lz_image.py build/firmware.intel.hex build/firmware.lz.hex
+
+See bootloader/include/lz4.h for the image format.
+"""
+
+import struct
+import sys
+
+from stream_upload import read_hex
+
+LZ4_IMAGE_MAGIC = 0x49345A4C
+LZ4_MAX_MATCH = 1024
+LZ4_MIN_MATCH = 4
+LZ4_MAX_OFFSET = 0xFFFF
+
+# The format requires the last match to start 12 bytes before the end and
+# the last 5 bytes to be literals
+LZ4_MATCH_LIMIT = 12
+LZ4_LAST_LITERALS = 5
+
+
+def put_length(out, length):
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+
+def put_sequence(out, literals, offset=0, match=0):
+    token_literals = min(len(literals), 15)
+    token_match = min(match - LZ4_MIN_MATCH, 15) if match else 0
+    out.append(token_literals << 4 | token_match)
+    if token_literals == 15:
+        put_length(out, len(literals) - 15)
+    out += literals
+    if match:
+        out += struct.pack("<H", offset)
+        if token_match == 15:
+            put_length(out, match - LZ4_MIN_MATCH - 15)
+
+
+def compress(data):
+    out = bytearray()
+    table = {}
+    anchor = position = 0
+    limit = len(data) - LZ4_MATCH_LIMIT
+    while position < limit:
+        key = data[position:position + LZ4_MIN_MATCH]
+        candidate = table.get(key)
+        table[key] = position
+        if candidate is None or position - candidate > LZ4_MAX_OFFSET:
+            position += 1
+            continue
+        length = LZ4_MIN_MATCH
+        while (position + length < len(data) - LZ4_LAST_LITERALS
+               and length < LZ4_MAX_MATCH
+               and data[candidate + length] == data[position + length]):
+            length += 1
+        put_sequence(out, data[anchor:position], position - candidate, length)
+        for skipped in range(position + 1, min(position + length, limit)):
+            table[data[skipped:skipped + LZ4_MIN_MATCH]] = skipped
+        position += length
+        anchor = position
+    put_sequence(out, data[anchor:])
+    return bytes(out)
+
+
+def write_hex(path, data):
+    with open(path, "w") as file:
+        for address in range(0, len(data), 16):
+            chunk = data[address:address + 16]
+            record = struct.pack(">BHB", len(chunk), address, 0) + chunk
+            checksum = -sum(record) & 0xFF
+            file.write(f":{record.hex().upper()}{checksum:02X}\n")
+        file.write(":00000001FF\n")
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__.strip())
+    image = read_hex(sys.argv[1])
+    compressed = struct.pack("<II", LZ4_IMAGE_MAGIC, len(image))
+    compressed += compress(image)
+    write_hex(sys.argv[2], compressed)
+    print(f"{sys.argv[2]}: {len(image)} bytes compressed to "
+          f"{len(compressed)} ({100 * len(compressed) / max(len(image), 1):.0f}%)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""Flat profile from a perf_profile_dump() capture and an unstripped ELF.
+
+Usage: profile.py build/firmware.debug.elf capture.txt [limit]
+"""
+
+import bisect
+import struct
+import sys
+
+STT_NOTYPE = 0
+STT_FUNC = 2
+SHT_SYMTAB = 2
+
+
+def read_symbols(path):
+    with open(path, "rb") as file:
+        elf = file.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        sys.exit(f"{path}: not a little-endian ELF32 file")
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum = struct.unpack_from("<HH", elf, 0x2E)
+    sections = [
+        struct.unpack_from("<IIIIIIIIII", elf, shoff + i * shentsize)
+        for i in range(shnum)
+    ]
+    symbols = {}
+    for _, sh_type, _, _, offset, size, link, _, _, entsize in sections:
+        if sh_type != SHT_SYMTAB:
+            continue
+        strtab = sections[link][4]
+        for entry in range(offset, offset + size, entsize):
+            name, value, _, info, _, shndx = struct.unpack_from(
+                "<IIIBBH", elf, entry)
+            if shndx == 0 or (info & 0xF) not in (STT_FUNC, STT_NOTYPE):
+                continue
+            end = elf.index(b"\0", strtab + name)
+            label = elf[strtab + name:end].decode()
+            if label and not label.startswith((".L", "$")):
+                symbols.setdefault(value, label)
+    if not symbols:
+        sys.exit(f"{path}: no symbols, use the unstripped .debug.elf")
+    return sorted(symbols.items())
+
+
+def read_samples(path):
+    samples = {}
+    total = outside = 0
+    with open(path, errors="replace") as file:
+        for line in file:
+            fields = line.split()
+            if len(fields) < 2 or fields[0] != "PROFILE":
+                continue
+            if fields[1] == "BEGIN":
+                samples.clear()
+                total, outside = int(fields[2]), int(fields[3])
+            elif fields[1] != "END":
+                samples[int(fields[1], 16)] = int(fields[2])
+    return samples, total, outside
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__.strip())
+    symbols = read_symbols(sys.argv[1])
+    samples, total, outside = read_samples(sys.argv[2])
+    limit = int(sys.argv[3]) if len(sys.argv) > 3 else 30
+    addresses = [address for address, _ in symbols]
+    profile = {}
+    for pc, count in samples.items():
+        index = bisect.bisect_right(addresses, pc) - 1
+        name = symbols[index][1] if index >= 0 else f"0x{pc:08x}"
+        profile[name] = profile.get(name, 0) + count
+    total = total or sum(samples.values()) or 1
+    print(f"{total} samples, {outside} outside of the histogram")
+    print(f"{'%':>7} {'samples':>9}  symbol")
+    ranked = sorted(profile.items(), key=lambda item: -item[1])
+    for name, count in ranked[:limit]:
+        print(f"{100 * count / total:7.2f} {count:9}  {name}")
+
+
+if __name__ == "__main__":
+    main()
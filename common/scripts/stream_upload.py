@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+"""Firmware upload through the bootloader's streaming mode.
+
+Usage: stream_upload.py build/firmware.intel.hex UART0 UART1
+
+The bootloader is reset and negotiated with over UART0 using STK500, after
+which the image is streamed over UART1 at 2 Mbaud. See
+bootloader/include/stream.h for the protocol.
+"""
+
+import fcntl
+import os
+import select
+import struct
+import sys
+import termios
+import time
+import zlib
+
+STK_OK = 0x10
+STK_INSYNC = 0x14
+CRC_EOP = 0x20
+STK_GET_SYNC = 0x30
+STK_SET_PARAMETER = 0x40
+STK_GET_PARAMETER = 0x41
+
+STK_PARAM_STREAM = 0x9F
+STREAM_VERSION = 1
+STREAM_SYNC = 0xA5
+STREAM_ACK = 0x06
+STREAM_NAK = 0x15
+STREAM_BLOCK_SIZE = 1024
+STREAM_WINDOW = 8
+STREAM_RESYNC = 0.05
+
+FW_SIZE = 0x7FFC
+SYNC_ATTEMPTS = 20
+RETRIES = 16
+
+
+def read_hex(path):
+    image = bytearray()
+    base = 0
+    with open(path) as file:
+        for line in file:
+            line = line.strip()
+            if not line.startswith(":"):
+                continue
+            record = bytes.fromhex(line[1:])
+            if sum(record) & 0xFF:
+                sys.exit(f"{path}: checksum mismatch in {line}")
+            length, address, kind = struct.unpack_from(">BHB", record)
+            data = record[4:4 + length]
+            if kind == 0:
+                start = base + address
+                if start + length > FW_SIZE:
+                    sys.exit(f"{path}: data at 0x{start:05x} is outside BRAM")
+                if len(image) < start + length:
+                    image.extend(bytes(start + length - len(image)))
+                image[start:start + length] = data
+            elif kind == 1:
+                break
+            elif kind == 2:
+                base = struct.unpack(">H", data)[0] << 4
+            elif kind == 4:
+                base = struct.unpack(">H", data)[0] << 16
+    return bytes(image)
+
+
+def open_port(path, baud):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    cc = termios.tcgetattr(fd)[6]
+    cc[termios.VMIN] = 0
+    cc[termios.VTIME] = 0
+    speed = getattr(termios, f"B{baud}")
+    cflag = termios.CS8 | termios.CREAD | termios.CLOCAL
+    termios.tcsetattr(fd, termios.TCSANOW,
+                      [0, 0, cflag, 0, speed, speed, cc])
+    termios.tcflush(fd, termios.TCIOFLUSH)
+    return fd
+
+
+def read_exact(fd, count, timeout):
+    data = b""
+    deadline = time.monotonic() + timeout
+    while len(data) < count:
+        remaining = deadline - time.monotonic()
+        if remaining <= 0 or not select.select([fd], [], [], remaining)[0]:
+            raise TimeoutError
+        data += os.read(fd, count - len(data))
+    return data
+
+
+def write_all(fd, data):
+    view = memoryview(data)
+    while view:
+        view = view[os.write(fd, view):]
+
+
+def set_dtr(fd, asserted):
+    request = termios.TIOCMBIS if asserted else termios.TIOCMBIC
+    fcntl.ioctl(fd, request, struct.pack("I", termios.TIOCM_DTR))
+
+
+def stk(fd, command, reply_length=0):
+    write_all(fd, bytes(command) + bytes([CRC_EOP]))
+    reply = read_exact(fd, reply_length + 2, 1.0)
+    if reply[0] != STK_INSYNC or reply[-1] != STK_OK:
+        raise ConnectionError(f"unexpected STK500 reply {reply.hex()}")
+    return reply[1:-1]
+
+
+def enter_bootloader(fd):
+    set_dtr(fd, False)
+    time.sleep(0.05)
+    set_dtr(fd, True)
+    for _ in range(SYNC_ATTEMPTS):
+        write_all(fd, bytes([STK_GET_SYNC, CRC_EOP]))
+        try:
+            if read_exact(fd, 2, 0.05) == bytes([STK_INSYNC, STK_OK]):
+                break
+        except TimeoutError:
+            pass
+    else:
+        sys.exit("bootloader is not responding on UART0")
+    # Replies to the remaining sync attempts
+    time.sleep(0.05)
+    termios.tcflush(fd, termios.TCIFLUSH)
+
+
+def frame(seq, data):
+    header = struct.pack("<HH", seq, len(data))
+    crc = zlib.crc32(header + data)
+    return bytes([STREAM_SYNC]) + header + data + struct.pack("<I", crc)
+
+
+def stream(fd, image):
+    blocks = [
+        frame(seq, image[offset:offset + STREAM_BLOCK_SIZE])
+        for seq, offset in enumerate(range(0, len(image), STREAM_BLOCK_SIZE))
+    ]
+    blocks.append(frame(len(blocks), b""))
+    acked = sent = retries = 0
+    while acked < len(blocks):
+        while sent < len(blocks) and sent - acked < STREAM_WINDOW:
+            write_all(fd, blocks[sent])
+            sent += 1
+        status, seq = struct.unpack("<BH", read_exact(fd, 3, 1.0))
+        if status == STREAM_ACK and acked <= seq <= sent:
+            acked = seq
+        elif status == STREAM_NAK and acked <= seq < sent:
+            retries += 1
+            if retries > RETRIES:
+                sys.exit(f"block {seq} rejected {RETRIES} times, giving up")
+            termios.tcdrain(fd)
+            time.sleep(STREAM_RESYNC)
+            termios.tcflush(fd, termios.TCIFLUSH)
+            acked = sent = seq
+        else:
+            sys.exit(f"unexpected reply {status:#04x} for block {seq}")
+    return retries
+
+
+def main():
+    if len(sys.argv) != 4:
+        sys.exit(__doc__.strip())
+    image = read_hex(sys.argv[1])
+    uart0 = open_port(sys.argv[2], 115200)
+    uart1 = open_port(sys.argv[3], 2000000)
+
+    started = time.monotonic()
+    enter_bootloader(uart0)
+    version = stk(uart0, [STK_GET_PARAMETER, STK_PARAM_STREAM], 1)[0]
+    if version != STREAM_VERSION:
+        sys.exit("bootloader does not support streaming, use avrdude")
+    stk(uart0, [STK_SET_PARAMETER, STK_PARAM_STREAM, STREAM_VERSION])
+    retries = stream(uart1, image)
+    print(f"{len(image)} bytes written in {time.monotonic() - started:.3f} s"
+          f", {retries} blocks resent")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,498 @@
+#include "cpu.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// Cycles per instruction without the timing model, a typical average of
+// PicoRV32 firmware running from BRAM
+#define CPU_CPI 6
+
+/* Cycles spent by the non-lookahead PicoRV32 core for each instruction class,
+ * assuming single-cycle memory, from the table in its documentation. */
+#define CYCLES_ALU 3
+#define CYCLES_SHIFT 4
+#define CYCLES_BRANCH 3
+#define CYCLES_BRANCH_TAKEN 5
+#define CYCLES_JAL 3
+#define CYCLES_JALR 6
+#define CYCLES_LOAD_STORE 5
+#define CYCLES_MUL 7 // FAST_MUL through PCPI
+#define CYCLES_DIV 40
+#define CYCLES_IRQ 4
+
+/* Extra cycles for every fetch and data access, caused by the Wishbone
+ * adapter and the slaves. The SDRAM controller opens a row and reads both
+ * halfwords of a word, which dominates writes to SDRAM. Reads that hit the
+ * SDRAM cache are as fast as BRAM, while misses read the whole line with
+ * the row kept open. */
+#define WAIT_BRAM 2
+#define WAIT_SDRAM 10
+#define WAIT_CACHE_FILL (WAIT_SDRAM + 2 * (CACHE_LINE_SIZE / 4 - 1) + 1)
+
+#define OPCODE_CUSTOM 0x0B
+
+enum CUSTOM_FUNCT7 {
+  CUSTOM_GETQ = 0,
+  CUSTOM_SETQ = 1,
+  CUSTOM_RETIRQ = 2,
+  CUSTOM_MASKIRQ = 3,
+  CUSTOM_WAITIRQ = 4,
+  CUSTOM_TIMER = 5,
+};
+
+// BRAM, BROM and SDRAM are kept in a flat array, only MMIO goes through Soc
+static inline bool is_memory(const uint32_t addr) {
+  return addr < SDRAM_END && addr - MMAP_START >= BROM_START - MMAP_START;
+}
+
+static inline bool is_mmap(const uint32_t addr) {
+  return addr - MMAP_START < BROM_START - MMAP_START;
+}
+
+// The BROM ignores writes
+static inline bool is_writable(const uint32_t addr) {
+  return addr < MMAP_START || (addr >= SDRAM_START && addr < SDRAM_END);
+}
+
+static inline uint32_t write_wait(const uint32_t addr) {
+  return addr >= SDRAM_START ? WAIT_SDRAM : WAIT_BRAM;
+}
+
+inline uint32_t Cpu::read_wait(const uint32_t addr) {
+  if (addr < SDRAM_START) {
+    return WAIT_BRAM;
+  }
+  return soc.cache.read(addr) ? WAIT_BRAM : WAIT_CACHE_FILL;
+}
+
+Cpu::Cpu(Soc &soc, const bool timing)
+    : soc(soc), memory(soc.memory.data()), timing(timing) {
+  x[2] = STACKADDR;
+}
+
+CPU_STOP Cpu::run(const uint64_t until) {
+  const CPU_STOP stop = timing ? execute<true>(until) : execute<false>(until);
+  soc.cycle = cycle;
+  return stop;
+}
+
+/* Delivers the events due by the current cycle and takes a pending interrupt
+ * unless the instruction after retirq has not been executed yet. */
+bool Cpu::check_events(void) {
+  soc.cycle = cycle;
+  if (soc.next_event <= cycle) {
+    soc.update();
+  }
+  if (timer_expires != 0 && timer_expires <= cycle) {
+    irq_pending |= CPU_IRQ_TIMER;
+    timer_expires = 0;
+  }
+  irq_pending |= soc.irq;
+  soc.irq = 0;
+  event = std::min(soc.next_event, timer_expires ? timer_expires : UINT64_MAX);
+
+  if (irq_delay) {
+    irq_delay = false;
+    event = 0;
+    return false;
+  }
+  return !irq_active && (irq_pending & ~irq_mask);
+}
+
+void Cpu::take_irq(void) {
+  q[0] = pc;
+  q[1] = irq_pending & ~irq_mask;
+  irq_pending &= irq_mask;
+  irq_active = true;
+  pc = PROGADDR_IRQ;
+  if (timing) {
+    cycle += CYCLES_IRQ;
+  }
+}
+
+/* Raises an internal interrupt in place of a trap, as CATCH_ILLINSN and
+ * CATCH_MISALIGN do when the interrupt is enabled. */
+bool Cpu::raise(const uint32_t irq) {
+  if ((irq_mask & irq) || irq_active) {
+    return false;
+  }
+  irq_pending |= irq;
+  event = 0;
+  return true;
+}
+
+uint32_t Cpu::mmap_load(const uint32_t addr, const uint32_t size) {
+  soc.cycle = cycle;
+  const uint32_t word = soc.mmap_read((addr & ~3) - MMAP_START);
+  event = 0;
+  return (word >> 8 * (addr & 3)) & (0xFFFFFFFF >> (32 - 8 * size));
+}
+
+void Cpu::mmap_store(const uint32_t addr, const uint32_t size,
+                     const uint32_t value) {
+  const uint32_t shift = 8 * (addr & 3);
+  const uint32_t mask = 0xFFFFFFFF >> (32 - 8 * size) << shift;
+  soc.cycle = cycle;
+  soc.mmap_write((addr & ~3) - MMAP_START, value << shift, mask);
+  event = 0;
+}
+
+template <bool TIMING> CPU_STOP Cpu::execute(const uint64_t until) {
+  while (cycle < until) {
+    if (cycle >= event && check_events()) {
+      take_irq();
+    }
+
+    uint32_t insn;
+    if ((pc & 3) != 0) {
+      if (!raise(CPU_IRQ_BUSERROR)) {
+        stop_pc = stop_addr = pc;
+        return CPU_STOP_TRAP;
+      }
+      continue;
+    } else if (is_memory(pc)) {
+      std::memcpy(&insn, memory + pc, 4);
+    } else if (is_mmap(pc)) {
+      insn = mmap_load(pc, 4);
+    } else {
+      stop_pc = stop_addr = pc;
+      return CPU_STOP_BUS_HANG;
+    }
+
+    const uint32_t rd = insn >> 7 & 0x1F;
+    const uint32_t funct3 = insn >> 12 & 0x7;
+    const uint32_t rs1 = x[insn >> 15 & 0x1F];
+    const uint32_t rs2 = x[insn >> 20 & 0x1F];
+    const int32_t imm_i = (int32_t)insn >> 20;
+    uint32_t next_pc = pc + 4;
+    uint32_t cycles = CYCLES_ALU;
+    bool illegal = false;
+
+    switch (insn & 0x7F) {
+    case 0x37: // lui
+      x[rd] = insn & 0xFFFFF000;
+      break;
+    case 0x17: // auipc
+      x[rd] = pc + (insn & 0xFFFFF000);
+      break;
+    case 0x6F: { // jal
+      if (insn == 0x6F) {
+        stop_pc = pc;
+        return CPU_STOP_HALT;
+      }
+      const int32_t imm = ((int32_t)insn >> 11 & 0xFFF00000) |
+                          (insn & 0xFF000) | (insn >> 9 & 0x800) |
+                          (insn >> 20 & 0x7FE);
+      x[rd] = next_pc;
+      next_pc = pc + imm;
+      cycles = CYCLES_JAL;
+      break;
+    }
+    case 0x67: // jalr
+      if (funct3 != 0) {
+        illegal = true;
+        break;
+      }
+      x[rd] = next_pc;
+      next_pc = (rs1 + imm_i) & ~1;
+      cycles = CYCLES_JALR;
+      break;
+    case 0x63: { // branches
+      bool taken;
+      switch (funct3) {
+      case 0:
+        taken = rs1 == rs2;
+        break;
+      case 1:
+        taken = rs1 != rs2;
+        break;
+      case 4:
+        taken = (int32_t)rs1 < (int32_t)rs2;
+        break;
+      case 5:
+        taken = (int32_t)rs1 >= (int32_t)rs2;
+        break;
+      case 6:
+        taken = rs1 < rs2;
+        break;
+      case 7:
+        taken = rs1 >= rs2;
+        break;
+      default:
+        illegal = true;
+        taken = false;
+        break;
+      }
+      if (taken) {
+        const int32_t imm = ((int32_t)insn >> 19 & 0xFFFFF000) |
+                            (insn << 4 & 0x800) | (insn >> 20 & 0x7E0) |
+                            (insn >> 7 & 0x1E);
+        next_pc = pc + imm;
+        cycles = CYCLES_BRANCH_TAKEN;
+      } else {
+        cycles = CYCLES_BRANCH;
+      }
+      break;
+    }
+    case 0x03: { // loads
+      const uint32_t addr = rs1 + imm_i;
+      const uint32_t size = 1 << (funct3 & 3);
+      cycles = CYCLES_LOAD_STORE;
+      if (funct3 == 3 || funct3 > 5) {
+        illegal = true;
+        break;
+      }
+      if ((addr & (size - 1)) != 0) {
+        if (!raise(CPU_IRQ_BUSERROR)) {
+          stop_pc = pc;
+          stop_addr = addr;
+          return CPU_STOP_TRAP;
+        }
+        break;
+      }
+      uint32_t value = 0;
+      if (is_memory(addr)) {
+        std::memcpy(&value, memory + addr, size);
+      } else if (is_mmap(addr)) {
+        value = mmap_load(addr, size);
+      } else {
+        stop_pc = pc;
+        stop_addr = addr;
+        return CPU_STOP_BUS_HANG;
+      }
+      if (funct3 == 0) {
+        value = (int8_t)value;
+      } else if (funct3 == 1) {
+        value = (int16_t)value;
+      }
+      x[rd] = value;
+      if (TIMING) {
+        cycles += read_wait(addr);
+      }
+      break;
+    }
+    case 0x23: { // stores
+      const uint32_t addr =
+          rs1 + (((int32_t)insn >> 20 & ~0x1F) | (insn >> 7 & 0x1F));
+      const uint32_t size = 1 << funct3;
+      cycles = CYCLES_LOAD_STORE;
+      if (funct3 > 2) {
+        illegal = true;
+        break;
+      }
+      if ((addr & (size - 1)) != 0) {
+        if (!raise(CPU_IRQ_BUSERROR)) {
+          stop_pc = pc;
+          stop_addr = addr;
+          return CPU_STOP_TRAP;
+        }
+        break;
+      }
+      if (is_writable(addr)) {
+        std::memcpy(memory + addr, &rs2, size);
+      } else if (is_mmap(addr)) {
+        mmap_store(addr, size, rs2);
+      } else if (addr >= SDRAM_END) {
+        stop_pc = pc;
+        stop_addr = addr;
+        return CPU_STOP_BUS_HANG;
+      }
+      if (TIMING) {
+        cycles += write_wait(addr);
+      }
+      break;
+    }
+    case 0x13: { // immediate arithmetic
+      const uint32_t shamt = imm_i & 0x1F;
+      switch (funct3) {
+      case 0:
+        x[rd] = rs1 + imm_i;
+        break;
+      case 1:
+        illegal = (insn >> 25) != 0;
+        x[rd] = illegal ? x[rd] : rs1 << shamt;
+        cycles = CYCLES_SHIFT;
+        break;
+      case 2:
+        x[rd] = (int32_t)rs1 < imm_i;
+        break;
+      case 3:
+        x[rd] = rs1 < (uint32_t)imm_i;
+        break;
+      case 4:
+        x[rd] = rs1 ^ imm_i;
+        break;
+      case 5:
+        if ((insn >> 25) == 0) {
+          x[rd] = rs1 >> shamt;
+        } else if ((insn >> 25) == 0x20) {
+          x[rd] = (int32_t)rs1 >> shamt;
+        } else {
+          illegal = true;
+        }
+        cycles = CYCLES_SHIFT;
+        break;
+      case 6:
+        x[rd] = rs1 | imm_i;
+        break;
+      case 7:
+        x[rd] = rs1 & imm_i;
+        break;
+      }
+      break;
+    }
+    case 0x33: { // register arithmetic
+      const uint32_t funct7 = insn >> 25;
+      if (funct7 == 0x01) {
+        cycles = funct3 < 4 ? CYCLES_MUL : CYCLES_DIV;
+        switch (funct3) {
+        case 0:
+          x[rd] = rs1 * rs2;
+          break;
+        case 1:
+          x[rd] = (int64_t)(int32_t)rs1 * (int32_t)rs2 >> 32;
+          break;
+        case 2:
+          x[rd] = (int64_t)(int32_t)rs1 * (uint64_t)rs2 >> 32;
+          break;
+        case 3:
+          x[rd] = (uint64_t)rs1 * rs2 >> 32;
+          break;
+        case 4:
+          x[rd] = rs2 == 0 ? 0xFFFFFFFF
+                  : rs1 == 0x80000000 && rs2 == 0xFFFFFFFF
+                      ? rs1
+                      : (uint32_t)((int32_t)rs1 / (int32_t)rs2);
+          break;
+        case 5:
+          x[rd] = rs2 == 0 ? 0xFFFFFFFF : rs1 / rs2;
+          break;
+        case 6:
+          x[rd] = rs2 == 0 ? rs1
+                  : rs1 == 0x80000000 && rs2 == 0xFFFFFFFF
+                      ? 0
+                      : (uint32_t)((int32_t)rs1 % (int32_t)rs2);
+          break;
+        case 7:
+          x[rd] = rs2 == 0 ? rs1 : rs1 % rs2;
+          break;
+        }
+        break;
+      }
+      if (funct7 != 0 && !(funct7 == 0x20 && (funct3 == 0 || funct3 == 5))) {
+        illegal = true;
+        break;
+      }
+      switch (funct3) {
+      case 0:
+        x[rd] = funct7 ? rs1 - rs2 : rs1 + rs2;
+        break;
+      case 1:
+        x[rd] = rs1 << (rs2 & 0x1F);
+        cycles = CYCLES_SHIFT;
+        break;
+      case 2:
+        x[rd] = (int32_t)rs1 < (int32_t)rs2;
+        break;
+      case 3:
+        x[rd] = rs1 < rs2;
+        break;
+      case 4:
+        x[rd] = rs1 ^ rs2;
+        break;
+      case 5:
+        x[rd] = funct7 ? (int32_t)rs1 >> (rs2 & 0x1F) : rs1 >> (rs2 & 0x1F);
+        cycles = CYCLES_SHIFT;
+        break;
+      case 6:
+        x[rd] = rs1 | rs2;
+        break;
+      case 7:
+        x[rd] = rs1 & rs2;
+        break;
+      }
+      break;
+    }
+    case 0x73: { // rdcycle[h], rdtime[h] and rdinstret[h], ecall and ebreak trap
+      const uint32_t csr = insn >> 20;
+      if (funct3 != 2 || (insn >> 15 & 0x1F) != 0 || (csr & 0x7F) > 2 ||
+          (csr & ~0x87) != 0xC00) {
+        illegal = true;
+        break;
+      }
+      const uint64_t counter = (csr & 0x7F) == 2 ? instret : cycle;
+      x[rd] = csr & 0x80 ? counter >> 32 : counter;
+      break;
+    }
+    case OPCODE_CUSTOM:
+      switch (insn >> 25) {
+      case CUSTOM_GETQ:
+        x[rd] = q[insn >> 15 & 0x3];
+        break;
+      case CUSTOM_SETQ:
+        q[rd & 0x3] = rs1;
+        break;
+      case CUSTOM_RETIRQ:
+        next_pc = q[0] & ~1;
+        irq_active = false;
+        irq_delay = true;
+        event = 0;
+        break;
+      case CUSTOM_MASKIRQ:
+        x[rd] = irq_mask;
+        irq_mask = rs1;
+        event = 0;
+        break;
+      case CUSTOM_WAITIRQ:
+        // Sleeps until the next event, the interrupt is only taken after
+        // waitirq returns the pending bits
+        irq_pending |= soc.irq;
+        soc.irq = 0;
+        while (irq_pending == 0) {
+          if (event == UINT64_MAX && soc.idle_forever()) {
+            stop_pc = pc;
+            return CPU_STOP_WAIT_FOREVER;
+          }
+          if (event >= until) {
+            cycle = std::max(cycle, until);
+            return CPU_STOP_LIMIT;
+          }
+          cycle = std::max(cycle, event);
+          check_events();
+        }
+        x[rd] = irq_pending;
+        event = 0;
+        break;
+      case CUSTOM_TIMER:
+        x[rd] = timer_expires > cycle ? timer_expires - cycle : 0;
+        timer_expires = rs1 ? cycle + rs1 : 0;
+        event = 0;
+        break;
+      default:
+        illegal = true;
+        break;
+      }
+      break;
+    default:
+      illegal = true;
+      break;
+    }
+
+    if (illegal) {
+      if (!raise(CPU_IRQ_EBREAK)) {
+        stop_pc = stop_addr = pc;
+        return CPU_STOP_TRAP;
+      }
+    }
+
+    x[0] = 0;
+    pc = next_pc;
+    ++instret;
+    if (TIMING) {
+      cycle += cycles + read_wait(pc);
+    } else {
+      cycle += CPU_CPI;
+    }
+  }
+  return CPU_STOP_LIMIT;
+}
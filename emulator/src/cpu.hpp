@@ -0,0 +1,68 @@
+#pragma once
+
+#include "soc.hpp"
+
+#include <cstdint>
+
+// PicoRV32 parameters from FPGA/src/top.v
+#define PROGADDR_RESET BROM_START
+#define PROGADDR_IRQ 0x00000040
+#define STACKADDR 0x0000BFFC
+
+enum CPU_IRQ {
+  CPU_IRQ_TIMER = 1 << 0,
+  CPU_IRQ_EBREAK = 1 << 1,
+  CPU_IRQ_BUSERROR = 1 << 2,
+};
+
+enum CPU_STOP {
+  CPU_STOP_NONE,
+  CPU_STOP_LIMIT,
+  CPU_STOP_HALT,
+  CPU_STOP_TRAP,
+  CPU_STOP_BUS_HANG,
+  CPU_STOP_WAIT_FOREVER,
+};
+
+/* Instruction-level model of the PicoRV32 configuration in top.v, including
+ * the custom interrupt instructions from picorv_ops.S. Without timing each
+ * instruction takes CPU_CPI cycles; with timing the cycle counts follow the
+ * non-lookahead PicoRV32 core and the wait states of the Wishbone slaves. */
+class Cpu {
+public:
+  Cpu(Soc &soc, const bool timing);
+
+  uint32_t x[32] = {};
+  uint32_t q[4] = {};
+  uint32_t pc = PROGADDR_RESET;
+  uint64_t instret = 0;
+
+  uint32_t irq_mask = 0xFFFFFFFF;
+  uint32_t irq_pending = 0;
+  bool irq_active = false;
+
+  uint32_t stop_pc = 0;
+  uint32_t stop_addr = 0;
+
+  /* Runs until the given cycle or until execution cannot continue. */
+  CPU_STOP run(const uint64_t until);
+
+private:
+  template <bool TIMING> CPU_STOP execute(const uint64_t until);
+  bool check_events(void);
+  void take_irq(void);
+  bool raise(const uint32_t irq);
+  uint32_t read_wait(const uint32_t addr);
+  uint32_t mmap_load(const uint32_t addr, const uint32_t size);
+  void mmap_store(const uint32_t addr, const uint32_t size,
+                  const uint32_t value);
+
+  Soc &soc;
+  uint8_t *const memory;
+  const bool timing;
+
+  uint64_t cycle = 0;
+  uint64_t event = 0;
+  uint64_t timer_expires = 0;
+  bool irq_delay = false;
+};
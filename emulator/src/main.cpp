@@ -0,0 +1,180 @@
+#include "cpu.hpp"
+#include "soc.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+
+// Cycles run between checks for idle UARTs and signals
+#define RUN_SLICE (1 << 20)
+
+static const char usage[] =
+    "Usage: emulator [options] [firmware.elf]\n"
+    "  -b ELF     boot from this bootloader instead of jumping to BRAM\n"
+    "  -c CYCLES  stop after this many cycles\n"
+    "  -i CYCLES  stop once the UARTs were idle for this many cycles\n"
+    "  -u PATH    connect UART0 to a file, FIFO or pseudo-terminal\n"
+    "  -t         count cycles per instruction class, memory region and\n"
+    "             SDRAM cache hit\n"
+    "  -g         print the LEDs, 7-segment display and LED matrix on exit\n"
+    "  -q         do not print the summary\n"
+    "UART1 is connected to stdin and stdout.\n";
+
+static volatile std::sig_atomic_t interrupted = 0;
+
+static void interrupt(const int) { interrupted = 1; }
+
+/* jal x0, offset */
+static uint32_t jump(const int32_t offset) {
+  const uint32_t imm = offset;
+  return (imm & 0x100000) << 11 | (imm & 0x7FE) << 20 | (imm & 0x800) << 9 |
+         (imm & 0xFF000) | 0x6F;
+}
+
+int main(int argc, char **argv) {
+  std::string firmware = "../firmware/build/firmware.elf";
+  std::string bootloader;
+  std::string uart0_path;
+  uint64_t max_cycles = 0;
+  uint64_t idle_cycles = 0;
+  bool timing = false;
+  bool gpio = false;
+  bool quiet = false;
+
+  int option;
+  while ((option = getopt(argc, argv, "b:c:i:u:tgqh")) != -1) {
+    switch (option) {
+    case 'b':
+      bootloader = optarg;
+      break;
+    case 'c':
+      max_cycles = std::strtoull(optarg, nullptr, 0);
+      break;
+    case 'i':
+      idle_cycles = std::strtoull(optarg, nullptr, 0);
+      break;
+    case 'u':
+      uart0_path = optarg;
+      break;
+    case 't':
+      timing = true;
+      break;
+    case 'g':
+      gpio = true;
+      break;
+    case 'q':
+      quiet = true;
+      break;
+    default:
+      std::fputs(usage, stderr);
+      return option == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  }
+  if (optind < argc) {
+    firmware = argv[optind];
+  }
+
+  Soc soc;
+  std::string error = soc.load_elf(firmware);
+  if (error.empty() && !bootloader.empty()) {
+    error = soc.load_elf(bootloader);
+  }
+  if (!error.empty()) {
+    std::fprintf(stderr, "emulator: %s\n", error.c_str());
+    return EXIT_FAILURE;
+  }
+  uint32_t reset_insn;
+  std::memcpy(&reset_insn, soc.memory.data() + BROM_START, 4);
+  if (reset_insn == 0) {
+    reset_insn = jump(BRAM_START - BROM_START);
+    std::memcpy(soc.memory.data() + BROM_START, &reset_insn, 4);
+  }
+
+  if (!uart0_path.empty()) {
+    const int fd = open(uart0_path.c_str(), O_RDWR | O_NONBLOCK | O_NOCTTY);
+    if (fd < 0) {
+      std::perror(("emulator: " + uart0_path).c_str());
+      return EXIT_FAILURE;
+    }
+    soc.uarts[0].in_fd = soc.uarts[0].out_fd = fd;
+  }
+  fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+  soc.uarts[1].in_fd = STDIN_FILENO;
+  soc.uarts[1].out_fd = STDOUT_FILENO;
+
+  std::signal(SIGINT, interrupt);
+  std::signal(SIGTERM, interrupt);
+
+  Cpu cpu(soc, timing);
+  const auto started = std::chrono::steady_clock::now();
+  const char *reason = "cycle limit reached";
+  int status = 2;
+  while (max_cycles == 0 || soc.cycle < max_cycles) {
+    uint64_t until = soc.cycle + RUN_SLICE;
+    if (max_cycles != 0) {
+      until = std::min(until, max_cycles);
+    }
+    const CPU_STOP stop = cpu.run(until);
+    if (stop == CPU_STOP_HALT) {
+      reason = "firmware halted";
+      status = 0;
+      break;
+    } else if (stop == CPU_STOP_WAIT_FOREVER) {
+      reason = "waiting for an interrupt that never comes";
+      status = 0;
+      break;
+    } else if (stop == CPU_STOP_TRAP) {
+      reason = "CPU trapped";
+      status = 1;
+      break;
+    } else if (stop == CPU_STOP_BUS_HANG) {
+      reason = "bus hung on an unmapped address";
+      status = 1;
+      break;
+    }
+
+    const uint64_t last_output =
+        std::max(soc.uarts[0].last_output, soc.uarts[1].last_output);
+    if (idle_cycles != 0 && soc.cycle - last_output >= idle_cycles) {
+      reason = "UARTs idle";
+      status = 0;
+      break;
+    }
+    if (interrupted) {
+      reason = "interrupted";
+      status = 130;
+      break;
+    }
+  }
+  soc.finish_tx();
+  for (Uart &uart : soc.uarts) {
+    uart.flush();
+  }
+
+  if (gpio) {
+    soc.print_gpio();
+  }
+  if (!quiet) {
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - started)
+                               .count();
+    std::fprintf(stderr,
+                 "\nemulator: %s after %llu cycles (%.3f ms), "
+                 "%llu instructions, %.3f s host time, %.1f MIPS\n",
+                 reason, (unsigned long long)soc.cycle,
+                 soc.cycle * 1e3 / CLK_FREQ_HZ,
+                 (unsigned long long)cpu.instret, seconds,
+                 cpu.instret / seconds / 1e6);
+    if (status == 1) {
+      std::fprintf(stderr, "emulator: pc 0x%05x, address 0x%08x\n",
+                   cpu.stop_pc, cpu.stop_addr);
+    }
+  }
+  return status;
+}
@@ -0,0 +1,521 @@
+#include "soc.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <elf.h>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+
+// Seven-segment patterns for hexadecimal digits, as driven by gpio_lprs1.vhd
+// Cycles of a DMA access plus the cycle with the bus released after it
+#define DMA_CYCLES_BRAM 3
+#define DMA_CYCLES_SDRAM 11
+#define DMA_CYCLES_CACHE_FILL (DMA_CYCLES_SDRAM + 2 * (CACHE_LINE_SIZE / 4 - 1) + 1)
+
+static const uint8_t segm_hex[16] = {
+    0x81, 0xCF, 0x92, 0x86, 0xCC, 0xA4, 0xA0, 0x8F,
+    0x80, 0x84, 0x82, 0xE0, 0xB1, 0xC2, 0xB0, 0xB8,
+};
+
+Soc::Soc(void) : memory(SDRAM_END) {
+  uarts[0].clocks_per_bit = CLK_FREQ_HZ / 115200;
+  uarts[1].clocks_per_bit = CLK_FREQ_HZ / 2000000;
+}
+
+std::string Soc::load_elf(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return path + ": cannot open file";
+  }
+  const std::vector<uint8_t> elf{std::istreambuf_iterator<char>(file), {}};
+  if (elf.size() < sizeof(Elf32_Ehdr)) {
+    return path + ": not an ELF file";
+  }
+  const Elf32_Ehdr *const header = (const Elf32_Ehdr *)elf.data();
+  if (std::string((const char *)header->e_ident, SELFMAG) != ELFMAG ||
+      header->e_ident[EI_CLASS] != ELFCLASS32 ||
+      header->e_ident[EI_DATA] != ELFDATA2LSB ||
+      header->e_machine != EM_RISCV) {
+    return path + ": not a little-endian RV32 ELF file";
+  }
+  if (header->e_phoff + (uint64_t)header->e_phnum * sizeof(Elf32_Phdr) >
+      elf.size()) {
+    return path + ": truncated program headers";
+  }
+  const Elf32_Phdr *const segments =
+      (const Elf32_Phdr *)(elf.data() + header->e_phoff);
+  for (uint32_t i = 0; i < header->e_phnum; ++i) {
+    const Elf32_Phdr &segment = segments[i];
+    if (segment.p_type != PT_LOAD || segment.p_filesz == 0) {
+      continue;
+    }
+    if ((uint64_t)segment.p_offset + segment.p_filesz > elf.size()) {
+      return path + ": truncated segment";
+    }
+    const uint64_t start = segment.p_paddr;
+    const uint64_t end = start + segment.p_filesz;
+    if (end > SDRAM_END || (start < BROM_START && end > MMAP_START)) {
+      char message[64];
+      std::snprintf(message, sizeof(message),
+                    ": segment at 0x%05x is not in memory", segment.p_paddr);
+      return path + message;
+    }
+    std::copy_n(elf.begin() + segment.p_offset, segment.p_filesz,
+                memory.begin() + start);
+  }
+  return "";
+}
+
+void Uart::flush(void) {
+  size_t written = 0;
+  while (out_fd >= 0 && written < output.size()) {
+    const ssize_t length =
+        write(out_fd, output.data() + written, output.size() - written);
+    if (length < 0 && errno != EINTR && errno != EAGAIN) {
+      out_fd = -1;
+    } else if (length > 0) {
+      written += length;
+    }
+  }
+  output.clear();
+}
+
+/* Timers count down on microsecond ticks, which occur on the last cycle of
+ * each CLOCKS_PER_US period since reset. The event is raised on the cycle
+ * after the count reaches zero. */
+uint64_t Soc::tick_after(const uint64_t start, const uint32_t micros) const {
+  if (micros == 0) {
+    return start;
+  }
+  const uint64_t first =
+      start + (CLOCKS_PER_US - 1) - start % CLOCKS_PER_US;
+  return first + (uint64_t)CLOCKS_PER_US * (micros - 1) + 1;
+}
+
+void Soc::timer_start(Timer &timer, const uint64_t start) {
+  timer.expires = tick_after(start, timer.interval);
+  next_event = std::min(next_event, timer.expires);
+}
+
+void Soc::uart_push_tx(Uart &uart, const uint8_t byte) {
+  if (uart.tx_fifo.size() < UART_FIFO_DEPTH) {
+    uart.tx_fifo.push_back(byte);
+  }
+  if (uart.tx_done == UINT64_MAX) {
+    uart.tx_done = cycle;
+    uart_update(uart);
+  }
+}
+
+uint32_t Soc::uart_pop_rx(Uart &uart) {
+  if (uart.rx_fifo.empty()) {
+    return 0xFFFFFFFF;
+  }
+  const uint8_t byte = uart.rx_fifo.front();
+  uart.rx_fifo.pop_front();
+  return byte;
+}
+
+void Soc::uart_update(Uart &uart) {
+  const uint64_t frame = 10 * uart.clocks_per_bit;
+
+  // tx_done is the end of the current frame, or when the next one can start
+  while (uart.tx_done <= cycle) {
+    if (uart.tx_busy) {
+      uart.output.push_back(uart.tx_byte);
+      uart.last_output = uart.tx_done;
+      uart.tx_busy = false;
+      irq |= SOC_IRQ_UART_TX;
+      if (uart.tx_byte == '\n' || uart.output.size() >= 4096) {
+        uart.flush();
+      }
+    }
+    if (uart.tx_fifo.empty()) {
+      uart.tx_done = UINT64_MAX;
+      break;
+    }
+    const bool low = uart.tx_fifo.size() <= UART_FIFO_DEPTH / 4;
+    uart.tx_byte = uart.tx_fifo.front();
+    uart.tx_fifo.pop_front();
+    uart.tx_busy = true;
+    uart.tx_done += frame + 2;
+    if (!low && uart.tx_fifo.size() <= UART_FIFO_DEPTH / 4) {
+      irq |= SOC_IRQ_UART_TX_THR;
+    }
+  }
+
+  while (uart.rx_done <= cycle) {
+    if (uart.rx_fifo.size() == UART_FIFO_DEPTH) {
+      uart.rx_overrun = true;
+    } else {
+      uart.rx_fifo.push_back(uart.rx_host.front());
+      if (uart.rx_fifo.size() == UART_FIFO_DEPTH / 2) {
+        irq |= SOC_IRQ_UART_RX_THR;
+      }
+    }
+    uart.rx_host.pop_front();
+    irq |= SOC_IRQ_UART_RX;
+    uart.rx_idle = uart.rx_done + UART_RX_IDLE_FRAMES * frame;
+    uart.rx_done = uart.rx_host.empty() ? UINT64_MAX : uart.rx_done + frame;
+  }
+
+  if (uart.rx_idle <= cycle) {
+    if (!uart.rx_fifo.empty()) {
+      irq |= SOC_IRQ_UART_RX_IDLE;
+    }
+    uart.rx_idle = UINT64_MAX;
+  }
+
+  if (uart.rx_host.empty() && uart.in_fd >= 0 && uart.rx_poll <= cycle) {
+    uint8_t buffer[256];
+    const ssize_t length = read(uart.in_fd, buffer, sizeof(buffer));
+    if (length > 0) {
+      uart.rx_host.insert(uart.rx_host.end(), buffer, buffer + length);
+      uart.rx_done = cycle + frame;
+    } else if (length == 0 || (errno != EAGAIN && errno != EINTR)) {
+      uart.in_fd = -1;
+    }
+    uart.rx_poll = cycle + frame * UART_FIFO_DEPTH;
+  }
+
+  next_event =
+      std::min({next_event, uart.tx_done, uart.rx_done, uart.rx_idle});
+  if (uart.in_fd >= 0 && uart.rx_host.empty()) {
+    next_event = std::min(next_event, uart.rx_poll);
+  }
+}
+
+uint32_t Soc::dma_access(const uint32_t addr, const bool write) {
+  if (addr < SDRAM_START) {
+    return DMA_CYCLES_BRAM;
+  }
+  if (write) {
+    return DMA_CYCLES_SDRAM;
+  }
+  return cache.read(addr) ? DMA_CYCLES_BRAM : DMA_CYCLES_CACHE_FILL;
+}
+
+void Soc::dma_start(void) {
+  dma.busy = dma.len != 0;
+  dma.fetched = false;
+  dma.next = cycle + 1;
+  if (!dma.busy) {
+    irq |= SOC_IRQ_DMA;
+    dma.next = UINT64_MAX;
+  }
+  next_event = std::min(next_event, dma.next);
+}
+
+// Copies move whole words with the low address bits ignored, as on the bus
+void Soc::dma_update(void) {
+  while (dma.busy && dma.next <= cycle) {
+    if (dma.mode == DMA_MODE_COPY) {
+      const uint32_t src = dma.src & ~3;
+      const uint32_t dst = dma.dst & ~3;
+      if (dst < MMAP_START || (dst >= SDRAM_START && dst < SDRAM_END)) {
+        uint32_t word = 0xFFFFFFFF;
+        if (src < SDRAM_END && (src < MMAP_START || src >= BROM_START)) {
+          std::copy_n(memory.begin() + src, 4, (uint8_t *)&word);
+        }
+        std::copy_n((const uint8_t *)&word, 4, memory.begin() + dst);
+      }
+      dma.next += dma_access(src, false) + dma_access(dst, true);
+      dma.src += 4;
+      dma.dst += 4;
+      dma.len = dma.len > 4 ? dma.len - 4 : 0;
+    } else {
+      Uart &uart = uarts[dma.mode == DMA_MODE_UART0 ? 0 : 1];
+      if (!dma.fetched) {
+        dma.fetched = true;
+        dma.next += dma_access(dma.src & ~3, false);
+        continue;
+      }
+      if (uart.tx_fifo.size() == UART_FIFO_DEPTH) {
+        // Resumes once the transmitter takes the next byte
+        dma.next = uart.tx_done;
+        break;
+      }
+      uint8_t byte = 0xFF;
+      if (dma.src < SDRAM_END &&
+          (dma.src < MMAP_START || dma.src >= BROM_START)) {
+        byte = memory[dma.src];
+      }
+      uart_push_tx(uart, byte);
+      dma.next += 1;
+      // The next word is read after the last byte of this one
+      dma.fetched = (dma.src & 3) != 3;
+      ++dma.src;
+      --dma.len;
+    }
+    if (dma.len == 0) {
+      dma.busy = false;
+      dma.next = UINT64_MAX;
+      irq |= SOC_IRQ_DMA;
+    }
+  }
+  next_event = std::min(next_event, dma.next);
+}
+
+void Soc::update(void) {
+  next_event = UINT64_MAX;
+  for (uint32_t i = 0; i < TIMER_COUNT; ++i) {
+    Timer &timer = timers[i];
+    if (timer_rst >> i & 1) {
+      continue;
+    }
+    if (timer.expires <= cycle) {
+      irq |= SOC_IRQ_TIMER0 << i;
+      const uint64_t period =
+          timer.interval ? (uint64_t)CLOCKS_PER_US * timer.interval : 1;
+      timer.expires += period * ((cycle - timer.expires) / period + 1);
+    }
+    next_event = std::min(next_event, timer.expires);
+  }
+  for (Uart &uart : uarts) {
+    uart_update(uart);
+  }
+  dma_update();
+}
+
+void Soc::finish_tx(void) {
+  const uint64_t stopped = cycle;
+  for (Uart &uart : uarts) {
+    while (uart.tx_done != UINT64_MAX) {
+      cycle = uart.tx_done;
+      uart_update(uart);
+    }
+  }
+  cycle = stopped;
+}
+
+bool Soc::idle_forever(void) const {
+  for (const Uart &uart : uarts) {
+    if (uart.in_fd >= 0 || !uart.rx_host.empty() ||
+        uart.tx_done != UINT64_MAX || uart.rx_idle != UINT64_MAX) {
+      return false;
+    }
+  }
+  return (timer_rst & 0xF) == 0xF;
+}
+
+uint32_t Soc::mmap_read(const uint32_t offset) {
+  switch (offset) {
+  case MMAP_LED_SEM:
+    return (uint32_t)sem << 8 | led;
+  case MMAP_COUNTER_NS:
+    return cycle * NANOS_PER_CLK;
+  case MMAP_COUNTER_NS + 4:
+    return cycle * NANOS_PER_CLK >> 32;
+  case MMAP_COUNTER_US:
+    return cycle / CLOCKS_PER_US;
+  case MMAP_COUNTER_US + 4:
+    return cycle / CLOCKS_PER_US >> 32;
+  case MMAP_COUNTER_MS:
+  case MMAP_COUNTER_MS + 4: {
+    const uint64_t clocks_per_ms = CLOCKS_PER_US * MICROS_PER_MS;
+    const uint64_t ms = cycle ? (cycle - 1) / clocks_per_ms : 0;
+    return offset == MMAP_COUNTER_MS ? ms : ms >> 32;
+  }
+  case MMAP_TIMER_RST:
+    return timer_rst;
+  case MMAP_TIMER_SEL:
+    return timer_sel;
+  case MMAP_UART0_RX_RDY:
+  case MMAP_UART1_RX_RDY:
+    return !uarts[(offset - MMAP_UART0_RX_RDY) / 8].rx_fifo.empty();
+  case MMAP_UART0_TX_RDY:
+  case MMAP_UART1_TX_RDY:
+    return uarts[(offset - MMAP_UART0_TX_RDY) / 8].tx_fifo.size() <
+           UART_FIFO_DEPTH;
+  case MMAP_UART0_RX:
+  case MMAP_UART1_RX:
+    return uart_pop_rx(uarts[(offset - MMAP_UART0_RX) / 8]);
+  case MMAP_UART0_RX_LVL:
+  case MMAP_UART1_RX_LVL: {
+    Uart &uart = uarts[(offset - MMAP_UART0_RX_LVL) / 8];
+    const uint32_t level = uart.rx_fifo.size() | uart.rx_overrun << 31;
+    uart.rx_overrun = false;
+    return level;
+  }
+  case MMAP_UART0_TX_LVL:
+  case MMAP_UART1_TX_LVL:
+    return uarts[(offset - MMAP_UART0_TX_LVL) / 8].tx_fifo.size();
+  case MMAP_CACHE_HITS:
+    return cache.hits;
+  case MMAP_CACHE_MISSES:
+    return cache.misses;
+  case MMAP_UART_FIFO_SZ:
+    return UART_FIFO_DEPTH;
+  case MMAP_DMA_SRC:
+    return dma.src;
+  case MMAP_DMA_DST:
+    return dma.dst;
+  case MMAP_DMA_LEN:
+    return dma.len;
+  case MMAP_DMA_CTRL:
+    return (uint32_t)dma.mode << 1 | dma.busy;
+  case MMAP_DISP_SWAP:
+    return 0;
+  case MMAP_DISP_MODE:
+    return disp_pwm;
+  case MMAP_INPUT_EVENT:
+  case MMAP_INPUT_TIME:
+    return 0;
+  case MMAP_INPUT_DEBOUNCE:
+    return input_debounce;
+  case MMAP_BTN_SW:
+    return (uint32_t)buttons << 8 | switches;
+  case MMAP_7SEGM_HEX:
+  case MMAP_7SEGM:
+    return segm_framebuffer();
+  default:
+    return 0xFFFFFFFF;
+  }
+}
+
+/* Segments lit on each digit, which the board reads back after multiplexing
+ * and which is updated here without the multiplexing delay. */
+uint32_t Soc::segm_framebuffer(void) const {
+  uint32_t framebuffer = 0;
+  for (uint32_t digit = 0; digit < 4; ++digit) {
+    const uint8_t segments = segm >> 32 ? segm >> (8 * digit)
+                                        : ~segm_hex[segm >> (4 * digit) & 0xF];
+    framebuffer |= (uint32_t)segments << (8 * digit);
+  }
+  return framebuffer;
+}
+
+void Soc::mmap_write(const uint32_t offset, const uint32_t value,
+                     const uint32_t mask) {
+  switch (offset) {
+  case MMAP_LED_SEM:
+    led = (value & mask) | (led & ~mask);
+    sem = ((value & mask) >> 8 | (sem & ~(mask >> 8))) & 0x7;
+    break;
+  case MMAP_7SEGM_HEX:
+    segm = ((value & mask & 0xFFFF) | (segm & ~(mask & 0xFFFF))) & 0xFFFFFFFF;
+    break;
+  case MMAP_7SEGM:
+    segm = 1ull << 32 | (value & mask) | (segm & ~mask);
+    break;
+  case MMAP_UART0_TX:
+  case MMAP_UART1_TX:
+    uart_push_tx(uarts[(offset - MMAP_UART0_TX) / 8], value);
+    break;
+  case MMAP_TIMER_RST: {
+    const uint8_t previous = timer_rst;
+    timer_rst = value & mask & 0xF;
+    for (uint32_t i = 0; i < TIMER_COUNT; ++i) {
+      if (timer_rst >> i & 1) {
+        timers[i].expires = UINT64_MAX;
+      } else if (previous >> i & 1) {
+        timer_start(timers[i], cycle + 1);
+      }
+    }
+    break;
+  }
+  case MMAP_DMA_SRC:
+  case MMAP_DMA_DST:
+  case MMAP_DMA_LEN:
+    // Reads return the running transfer, so writes wait until it ends
+    if (!dma.busy) {
+      uint32_t &reg = offset == MMAP_DMA_SRC   ? dma.src
+                      : offset == MMAP_DMA_DST ? dma.dst
+                                               : dma.len;
+      reg = value;
+    }
+    break;
+  case MMAP_DMA_CTRL:
+    if (!dma.busy) {
+      dma.mode = value >> 1 & 0x3;
+      if (value & 1) {
+        dma_start();
+      }
+    }
+    break;
+  case MMAP_TIMER_SEL:
+    timer_sel = value & mask & 0x3;
+    timers[timer_sel].interval = timer_int;
+    break;
+  case MMAP_TIMER_INT:
+    timer_int = value & mask;
+    timers[timer_sel].interval = timer_int;
+    break;
+  case MMAP_DISP_SWAP:
+    // Swapped at once instead of at the end of the multiplexed frame
+    if (value & mask & 1) {
+      for (uint32_t pos = 0; pos < DISP_PIXELS; ++pos) {
+        const uint32_t bit = pos % 8 * 8 + pos / 8;
+        uint8_t color = 0;
+        for (uint32_t plane = 0; plane < 3; ++plane) {
+          color |= (disp_back[2 * plane + bit / 32] >> bit % 32 & 1) << plane;
+        }
+        disp[pos] = color;
+      }
+      disp_pwm_bank ^= 1;
+    }
+    break;
+  case MMAP_INPUT_DEBOUNCE:
+    input_debounce = (value & mask) | (input_debounce & ~mask);
+    break;
+  case MMAP_DISP_MODE:
+    if (mask & 1) {
+      disp_pwm = value & 1;
+    }
+    break;
+  default:
+    if (offset >= MMAP_DISP_PLANE && offset < MMAP_DISP_SWAP) {
+      uint32_t &plane = disp_back[(offset - MMAP_DISP_PLANE) / 4];
+      plane = (value & mask) | (plane & ~mask);
+    }
+    if (offset >= MMAP_DISP && offset < MMAP_DISP_END) {
+      disp[(offset - MMAP_DISP) / 4] = value & mask & 0x7;
+    }
+    if (offset >= MMAP_DISP_PWM && offset < MMAP_DISP_PWM_END) {
+      uint32_t &word =
+          disp_pwm_banks[disp_pwm_bank ^ 1][(offset - MMAP_DISP_PWM) / 4];
+      word = (value & mask) | (word & ~mask);
+    }
+    break;
+  }
+}
+
+void Soc::print_gpio(void) const {
+  static const char colors[] = " RGYBMCW";
+  char bits[12] = {};
+  for (uint32_t i = 0; i < 11; ++i) {
+    bits[i] = ((uint32_t)sem << 8 | led) >> (10 - i) & 1 ? '1' : '0';
+  }
+  std::fprintf(stderr, "semaphore %.3s  LED %s  7segm %08x\n", bits,
+               bits + 3, segm_framebuffer());
+  char matrix[8][9] = {};
+  for (uint32_t pos = 0; pos < DISP_PIXELS; ++pos) {
+    const uint32_t row = pos % 8;
+    const uint32_t column = (13 - pos / 8) % 8;
+    matrix[row][column] = colors[disp[pos]];
+  }
+  if (disp_pwm) {
+    // Intensities as 0xRGB, in the same column order as the pixels
+    const uint32_t *const words = disp_pwm_banks[disp_pwm_bank];
+    for (uint32_t row = 0; row < 8; ++row) {
+      uint32_t rgb[8];
+      for (uint32_t x = 0; x < 8; ++x) {
+        const uint32_t bit = row * 96 + x * 12;
+        uint64_t pair = words[bit / 32];
+        if (bit % 32 > 20) {
+          pair |= (uint64_t)words[bit / 32 + 1] << 32;
+        }
+        rgb[(13 - x) % 8] = pair >> bit % 32 & 0xFFF;
+      }
+      std::fprintf(stderr, "|%03x %03x %03x %03x %03x %03x %03x %03x|\n",
+                   rgb[0], rgb[1], rgb[2], rgb[3], rgb[4], rgb[5], rgb[6],
+                   rgb[7]);
+    }
+    return;
+  }
+  for (uint32_t row = 0; row < 8; ++row) {
+    std::fprintf(stderr, "|%s|\n", matrix[row]);
+  }
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Address map from FPGA/src/wishbone.vhd
+#define BRAM_START 0x00000
+#define MMAP_START 0x0C000
+#define BROM_START 0x10000
+#define SDRAM_START 0x11000
+#define SDRAM_END 0x100000
+
+#define CLK_FREQ_HZ 50000000
+#define NANOS_PER_CLK 20
+#define CLOCKS_PER_US 51    // countdown from 1000 by 20 ns, plus the reload
+#define MICROS_PER_MS 1000
+
+#define TIMER_COUNT 4
+#define UART_COUNT 2
+#define UART_FIFO_DEPTH 16
+#define UART_RX_IDLE_FRAMES 4
+#define DISP_PIXELS 64
+
+// Geometry of the SDRAM cache from FPGA/src/cache.vhd
+#define CACHE_LINES 256
+#define CACHE_LINE_SIZE 16
+
+// Register offsets from FPGA/src/peripherals.vhd
+enum MMAP_REGISTER {
+  MMAP_LED_SEM = 0x0000,
+  MMAP_COUNTER_NS = 0x0004,
+  MMAP_COUNTER_US = 0x000C,
+  MMAP_COUNTER_MS = 0x0014,
+  MMAP_TIMER_RST = 0x0020,
+  MMAP_TIMER_SEL = 0x0024,
+  MMAP_TIMER_INT = 0x0028,
+  MMAP_UART0_RX_RDY = 0x0030,
+  MMAP_UART0_TX_RDY = 0x0034,
+  MMAP_UART1_RX_RDY = 0x0038,
+  MMAP_UART1_TX_RDY = 0x003C,
+  MMAP_UART0_RX = 0x0040,
+  MMAP_UART0_TX = 0x0044,
+  MMAP_UART1_RX = 0x0048,
+  MMAP_UART1_TX = 0x004C,
+  MMAP_BTN_SW = 0x0050,
+  MMAP_7SEGM_HEX = 0x0054,
+  MMAP_7SEGM = 0x0058,
+  MMAP_DISP = 0x005C,
+  MMAP_DISP_END = 0x015C,
+  MMAP_UART0_RX_LVL = 0x0160,
+  MMAP_UART0_TX_LVL = 0x0164,
+  MMAP_UART1_RX_LVL = 0x0168,
+  MMAP_UART1_TX_LVL = 0x016C,
+  MMAP_UART_FIFO_SZ = 0x0170,
+  MMAP_CACHE_HITS = 0x0180,
+  MMAP_CACHE_MISSES = 0x0184,
+  MMAP_DMA_SRC = 0x0190,
+  MMAP_DMA_DST = 0x0194,
+  MMAP_DMA_LEN = 0x0198,
+  MMAP_DMA_CTRL = 0x019C,
+  MMAP_DISP_PLANE = 0x01A0,
+  MMAP_DISP_SWAP = 0x01B8,
+  MMAP_DISP_MODE = 0x01BC,
+  MMAP_INPUT_EVENT = 0x01C0,
+  MMAP_INPUT_TIME = 0x01C4,
+  MMAP_INPUT_DEBOUNCE = 0x01C8,
+  MMAP_DISP_PWM = 0x0300,
+  MMAP_DISP_PWM_END = 0x0360,
+};
+
+enum SOC_IRQ {
+  SOC_IRQ_TIMER0 = 1 << 4,
+  SOC_IRQ_UART_RX = 1 << 8,
+  SOC_IRQ_UART_TX = 1 << 9,
+  SOC_IRQ_UART_RX_THR = 1 << 10,
+  SOC_IRQ_UART_TX_THR = 1 << 11,
+  SOC_IRQ_DMA = 1 << 12,
+  SOC_IRQ_UART_RX_IDLE = 1 << 13,
+};
+
+struct Timer {
+  uint32_t interval = 0xFFFFFFFF;
+  uint64_t expires = UINT64_MAX;
+};
+
+/* Byte-level UART with the FIFOs, interrupts and line timing of
+ * UART_Buffered, exchanging data with a pair of host file descriptors. */
+struct Uart {
+  uint32_t clocks_per_bit;
+  int in_fd = -1;
+  int out_fd = -1;
+
+  std::deque<uint8_t> tx_fifo;
+  uint64_t tx_done = UINT64_MAX;
+  uint8_t tx_byte = 0;
+  bool tx_busy = false;
+
+  std::deque<uint8_t> rx_fifo;
+  std::deque<uint8_t> rx_host;
+  uint64_t rx_done = UINT64_MAX;
+  uint64_t rx_poll = 0;
+  uint64_t rx_idle = UINT64_MAX;
+  bool rx_overrun = false;
+
+  std::vector<uint8_t> output;
+  uint64_t last_output = 0;
+
+  void flush(void);
+};
+
+/* Tags of the direct-mapped write-through SDRAM cache, which only decide the
+ * timing of SDRAM reads and the hit and miss counters. */
+struct SdramCache {
+  uint32_t tags[CACHE_LINES] = {}; // line number plus one, zero is invalid
+  uint32_t hits = 0;
+  uint32_t misses = 0;
+
+  bool read(const uint32_t addr) {
+    const uint32_t line = (addr - SDRAM_START) / CACHE_LINE_SIZE;
+    uint32_t &tag = tags[line % CACHE_LINES];
+    if (tag == line + 1) {
+      ++hits;
+      return true;
+    }
+    tag = line + 1;
+    ++misses;
+    return false;
+  }
+};
+
+enum DMA_MODE {
+  DMA_MODE_COPY = 0b00,
+  DMA_MODE_UART0 = 0b01,
+  DMA_MODE_UART1 = 0b10,
+};
+
+/* Descriptor of DMA_Controller, advanced one word or byte per step. Steps
+ * take the cycles of the controller's own bus accesses, while the CPU is
+ * not slowed down by sharing the bus. */
+struct Dma {
+  uint32_t src = 0;
+  uint32_t dst = 0;
+  uint32_t len = 0;
+  uint8_t mode = DMA_MODE_COPY;
+  bool busy = false;
+  bool fetched = false;
+  uint64_t next = UINT64_MAX;
+};
+
+class Soc {
+public:
+  Soc(void);
+
+  std::vector<uint8_t> memory;
+
+  uint64_t cycle = 0;
+  uint64_t next_event = 0;
+  uint32_t irq = 0;
+
+  Uart uarts[UART_COUNT];
+  uint8_t buttons = 0;
+  uint8_t switches = 0;
+  uint16_t input_debounce = 5000; // inputs never change, so no events
+  SdramCache cache;
+
+  std::string load_elf(const std::string &path);
+
+  uint32_t mmap_read(const uint32_t offset);
+  void mmap_write(const uint32_t offset, const uint32_t value,
+                  const uint32_t mask);
+
+  /* Raises the interrupts of all events up to the current cycle and
+   * schedules the next one. */
+  void update(void);
+  /* Sends the bytes left in the TX FIFOs, as the UARTs do after a halt. */
+  void finish_tx(void);
+  bool idle_forever(void) const;
+  void print_gpio(void) const;
+
+private:
+  uint64_t tick_after(const uint64_t start, const uint32_t micros) const;
+  void timer_start(Timer &timer, const uint64_t start);
+  uint32_t dma_access(const uint32_t addr, const bool write);
+  void dma_start(void);
+  void dma_update(void);
+  void uart_push_tx(Uart &uart, const uint8_t byte);
+  void uart_update(Uart &uart);
+  uint32_t uart_pop_rx(Uart &uart);
+  uint32_t segm_framebuffer(void) const;
+
+  Timer timers[TIMER_COUNT];
+  uint8_t timer_rst = 0xF;
+  uint8_t timer_sel = 0;
+  uint32_t timer_int = 0xFFFFFFFF;
+
+  Dma dma;
+
+  uint8_t led = 0;
+  uint8_t sem = 0;
+  uint64_t segm = 0x10E67055B; // LPrS
+  uint8_t disp[DISP_PIXELS] = {};
+  uint32_t disp_back[6] = {}; // red, green and blue planes, a byte per row
+  bool disp_pwm = false;
+  uint8_t disp_pwm_bank = 0;
+  uint32_t disp_pwm_banks[2][24] = {}; // 12 bit pixels, three words per row
+};
@@ -1,42 +1,29 @@
 #include <hal/gpio.h>
+#include <hal/input.h>
 #include <hal/irq.h>
 #include <hal/time.h>
 #include <stdio.h>
 
-#define BTN_COUNT 5
-#define DEBOUNCE_TIMEOUT 10
+/* Buttons are debounced in hardware, which raises a single interrupt for
+ * every settled press or release and queues it with its time, so the
+ * handler only counts them and the loop prints them outside of it. */
 
-void print_event(const usize button, const enum DIGITAL_STATE state) {
-  const char *BTN_NAME[BTN_COUNT] = {"UP", "DOWN", "LEFT", "RIGHT", "CENTER"};
-  switch (state) {
-  case LOW:
-    printf("Button %s released\n", BTN_NAME[button]);
-    break;
-  case HIGH:
-    printf("Button %s pressed\n", BTN_NAME[button]);
-    break;
-  }
-}
+static volatile usize button_irqs;
 
-void process_button(const usize button) {
-  static u64 debounce[BTN_COUNT] = {};
-  static enum DIGITAL_STATE btn_state[BTN_COUNT] = {};
-  if (millis() - debounce[button] < DEBOUNCE_TIMEOUT) {
-    return;
-  }
-  debounce[button] = millis();
-  const enum DIGITAL_STATE new_state = get_btn((enum BUTTON)1 << button);
-  if (btn_state[button] == new_state) {
+void print_event(const struct InputEvent *const event) {
+  const char *BTN_NAME[] = {"UP", "DOWN", "LEFT", "RIGHT", "CENTER"};
+  if (!input_is_button(event->input)) {
+    printf("%10u us  Switch %u %s\n", event->micros, event->input,
+           event->state == HIGH ? "on" : "off");
     return;
   }
-  btn_state[button] = new_state;
-  print_event(button, new_state);
+  printf("%10u us  Button %s %s (%u interrupts)\n", event->micros,
+         BTN_NAME[event->input - INPUT_BTN_UP],
+         event->state == HIGH ? "pressed" : "released", button_irqs);
 }
 
 void button_event(const usize irq, union StackFrame *const stack_frame) {
-  for (usize i = 0; i < BTN_COUNT; ++i) {
-    process_button(i);
-  }
+  ++button_irqs;
 }
 
 void setup(void) {
@@ -46,6 +33,13 @@ void setup(void) {
 
 void loop(void) {
   static usize digit = 0;
+  struct InputEvent event;
+  while (input_poll_event(&event)) {
+    if (event.overrun) {
+      printf("Events were dropped\n");
+    }
+    print_event(&event);
+  }
   set_7segm(0b00000001 << (digit << 3));
   sleep(250);
   digit = (digit + 1) & 0b11;
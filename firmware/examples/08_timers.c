@@ -1,3 +1,4 @@
+#include <hal/defer.h>
 #include <hal/gpio.h>
 #include <hal/irq.h>
 #include <hal/time.h>
@@ -15,10 +16,15 @@ static volatile usize seconds = 0;
 static volatile usize minutes = 0;
 static volatile usize hours = 0;
 
-void print_clock(const usize irq, union StackFrame *const stack_frame) {
+void print_clock(const void *const argument) {
   printf("Current time is %02i:%02i:%02i\n", hours, minutes, seconds);
 }
 
+// Printing waits for the UART, so it is left to the main loop
+void clock_event(const usize irq, union StackFrame *const stack_frame) {
+  defer_post(print_clock, NULLPTR);
+}
+
 void increment_seconds(const usize irq, union StackFrame *const stack_frame) {
   if (seconds < SECONDS_IN_MINUTE - 1) {
     ++seconds;
@@ -48,7 +54,7 @@ void setup(void) {
   timer_set_interval(TIMER1, MICROSECOND_IN_SECOND);
   timer_set_interval(TIMER2, MICROSECOND_IN_MINUTE);
   timer_set_interval(TIMER3, MICROSECOND_IN_HOUR);
-  irq_set_handler(IRQ_TIMER0, print_clock);
+  irq_set_handler(IRQ_TIMER0, clock_event);
   irq_set_handler(IRQ_TIMER1, increment_seconds);
   irq_set_handler(IRQ_TIMER2, increment_minutes);
   irq_set_handler(IRQ_TIMER3, increment_hours);
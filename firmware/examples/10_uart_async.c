@@ -0,0 +1,57 @@
+#include <hal/time.h>
+#include <hal/uart.h>
+#include <stdio.h>
+
+#define MESSAGE "The quick brown fox jumps over the lazy dog 0123456789\n"
+#define MESSAGE_LENGTH (sizeof(MESSAGE) - 1)
+#define ROUNDS 8
+
+struct Measurement {
+  u64 total_ns;
+  u64 blocked_ns;
+  usize work;
+};
+
+static volatile usize work_counter;
+
+void do_work(void) { ++work_counter; }
+
+struct Measurement measure(const bool async) {
+  struct Measurement result = {};
+  uart_set_async(UART0, async);
+  work_counter = 0;
+  const u64 start = nanos();
+  for (usize round = 0; round < ROUNDS; ++round) {
+    const u64 blocked_start = nanos();
+    put_buff(UART0, MESSAGE, MESSAGE_LENGTH);
+    result.blocked_ns += nanos() - blocked_start;
+    while (uart_tx_pending(UART0) > MESSAGE_LENGTH / 2) {
+      do_work();
+    }
+  }
+  while (uart_tx_pending(UART0) > 0) {
+    do_work();
+  }
+  result.total_ns = nanos() - start;
+  result.work = work_counter;
+  uart_set_async(UART0, false);
+  return result;
+}
+
+void report(const char *const name, const struct Measurement *const m) {
+  const usize total_us = m->total_ns / 1000;
+  const usize blocked_us = m->blocked_ns / 1000;
+  printf("%-8s total %6u us, blocked %6u us (%3u%% CPU), work %u\n", name,
+         total_us, blocked_us, total_us ? blocked_us * 100 / total_us : 0,
+         m->work);
+}
+
+void setup(void) {
+  const struct Measurement sync = measure(false);
+  const struct Measurement async = measure(true);
+  printf("UART0 %u bytes x %u rounds\n", MESSAGE_LENGTH, ROUNDS);
+  report("blocking", &sync);
+  report("async", &async);
+}
+
+void loop(void) {}
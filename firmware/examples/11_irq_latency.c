@@ -0,0 +1,50 @@
+#include <hal/irq.h>
+#include <hal/perf.h>
+#include <stdio.h>
+
+#define ITERATIONS 1000
+
+static volatile u32 handler_entered;
+
+void ecall_handler(const usize irq, union StackFrame *const stack_frame) {
+  handler_entered = perf_cycles32();
+}
+
+void measure(const char *const name) {
+  u32 latency_sum = 0;
+  u32 latency_max = 0;
+  const u32 start = perf_cycles32();
+  for (usize i = 0; i < ITERATIONS; ++i) {
+    const u32 before = perf_cycles32();
+    irq_ecall();
+    const u32 latency = handler_entered - before;
+    latency_sum += latency;
+    if (latency > latency_max) {
+      latency_max = latency;
+    }
+  }
+  const u32 total = perf_cycles32() - start;
+  printf("%-16s entry avg %5u, max %5u, round trip %5u cycles\n", name,
+         latency_sum / ITERATIONS, latency_max, total / ITERATIONS);
+}
+
+void setup(void) {
+  static const char *const LEVELS[IRQ_PRIORITY_COUNT] = {
+      "low priority", "normal priority", "high priority", "critical priority"};
+  irq_set_enabled(IRQ_ECALL);
+  irq_set_handler_frame(IRQ_ECALL, ecall_handler, IRQ_FRAME_CALLER_SAVED);
+  measure("caller-saved");
+  irq_set_handler_frame(IRQ_ECALL, ecall_handler, IRQ_FRAME_FULL);
+  measure("full frame");
+
+  /* Dispatch visits the levels from critical down, so the lower ones wait
+   * for the higher ones to be checked first */
+  irq_set_handler(IRQ_ECALL, ecall_handler);
+  for (isize level = IRQ_PRIORITY_COUNT - 1; level >= 0; --level) {
+    irq_set_priority(IRQ_ECALL, level);
+    measure(LEVELS[level]);
+  }
+  irq_set_priority(IRQ_ECALL, IRQ_PRIORITY_NORMAL);
+}
+
+void loop(void) {}
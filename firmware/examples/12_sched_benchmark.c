@@ -0,0 +1,42 @@
+#include <hal/perf.h>
+#include <hal/sched.h>
+#include <hal/time.h>
+#include <stdio.h>
+
+#define SWITCHES 1000
+#define WINDOW_MS 200
+
+static volatile usize switches_left;
+
+void ping_pong(const void *const arg) {
+  while (switches_left > 0) {
+    --switches_left;
+    thread_yield();
+  }
+}
+
+void setup(void) {
+  sched_start(SCHED_PRIORITY_NORMAL);
+
+  const usize state = sched_lock();
+  switches_left = SWITCHES;
+  thread_create(ping_pong, NULLPTR, SCHED_PRIORITY_HIGHEST, SCHED_STACK_SIZE);
+  thread_create(ping_pong, NULLPTR, SCHED_PRIORITY_HIGHEST, SCHED_STACK_SIZE);
+  const u64 start = nanos();
+  sched_unlock(state);
+  thread_yield();
+  const u64 elapsed = nanos() - start;
+  printf("context switch: %u ns\n", (usize)(elapsed / SWITCHES));
+
+  timer_set_enabled(TIMER0, false);
+  const u32 idle_iterations = perf_idle_count(WINDOW_MS);
+  timer_set_enabled(TIMER0, true);
+  const u32 tick_iterations = perf_idle_count(WINDOW_MS);
+  const u64 ticks = WINDOW_MS * 1000 / SCHED_TIME_SLICE;
+  const u64 lost_ns =
+      perf_idle_lost_ns(idle_iterations, tick_iterations, WINDOW_MS);
+  printf("tick overhead: %u ns per %u us slice\n", (usize)(lost_ns / ticks),
+         SCHED_TIME_SLICE);
+}
+
+void loop(void) {}
@@ -0,0 +1,74 @@
+#include <hal/irq.h>
+#include <hal/sched.h>
+#include <hal/sync.h>
+#include <hal/time.h>
+#include <stdio.h>
+
+#define HANDOFFS 1000
+#define WAKEUPS 1000
+
+static struct Mutex mutex;
+static struct Semaphore contended;
+static struct Semaphore ticked;
+static struct Semaphore done;
+
+static volatile u32 released_at;
+static volatile u32 fired_at;
+static u64 handoff_sum;
+static u64 wakeup_sum;
+
+void waiter(const void *const arg) {
+  for (usize i = 0; i < HANDOFFS; ++i) {
+    semaphore_wait(&contended);
+    mutex_lock(&mutex);
+    handoff_sum += nanos32() - released_at;
+    mutex_unlock(&mutex);
+  }
+  semaphore_post(&done);
+}
+
+void holder(const void *const arg) {
+  for (usize i = 0; i < HANDOFFS; ++i) {
+    mutex_lock(&mutex);
+    semaphore_post(&contended);
+    released_at = nanos32();
+    mutex_unlock(&mutex);
+  }
+}
+
+void timer_handler(const usize irqs, union StackFrame *const stack_frame) {
+  fired_at = nanos32();
+  semaphore_post(&ticked);
+}
+
+void listener(const void *const arg) {
+  for (usize i = 0; i < WAKEUPS; ++i) {
+    semaphore_wait(&ticked);
+    wakeup_sum += nanos32() - fired_at;
+  }
+  semaphore_post(&done);
+}
+
+void setup(void) {
+  mutex_init(&mutex);
+  semaphore_init(&contended, 0);
+  semaphore_init(&ticked, 0);
+  semaphore_init(&done, 0);
+  sched_start(SCHED_PRIORITY_NORMAL + 1);
+
+  thread_create(waiter, NULLPTR, SCHED_PRIORITY_HIGHEST, SCHED_STACK_SIZE);
+  thread_create(holder, NULLPTR, SCHED_PRIORITY_NORMAL, SCHED_STACK_SIZE);
+  semaphore_wait(&done);
+  printf("mutex handoff: %u ns\n", (usize)(handoff_sum / HANDOFFS));
+
+  irq_set_handler(IRQ_TIMER1, timer_handler);
+  irq_set_enabled(irq_get_enabled() | IRQ_TIMER1);
+  timer_set_interval(TIMER1, 1000);
+  thread_create(listener, NULLPTR, SCHED_PRIORITY_HIGHEST, SCHED_STACK_SIZE);
+  timer_set_enabled(TIMER1, true);
+  semaphore_wait(&done);
+  timer_set_enabled(TIMER1, false);
+  printf("interrupt wakeup: %u ns\n", (usize)(wakeup_sum / WAKEUPS));
+}
+
+void loop(void) {}
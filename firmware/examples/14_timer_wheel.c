@@ -0,0 +1,50 @@
+#include <hal/perf.h>
+#include <hal/timer.h>
+#include <stdio.h>
+
+#define TIMER_COUNT 4096
+#define WINDOW_MS 1000
+
+extern u8 __sdram_start;
+
+static volatile u32 expirations;
+
+void count_expiration(struct SoftTimer *const timer, void *const argument) {
+  ++expirations;
+}
+
+u32 rand(const u32 range_start, const u32 range_end) {
+  const u32 A = 1664525;
+  const u32 C = 1013904223;
+  const u32 M = 2147483648;
+  static u32 seed;
+  seed = (A * seed + C) % M;
+  return range_start + (seed % (range_end - range_start + 1));
+}
+
+void setup(void) {
+  struct SoftTimer *const timers = (struct SoftTimer *)&__sdram_start;
+  const u32 idle_iterations = perf_idle_count(WINDOW_MS);
+
+  for (usize i = 0; i < TIMER_COUNT; ++i) {
+    timer_init(&timers[i]);
+    timer_start_periodic(&timers[i], rand(1, 500), count_expiration, NULLPTR);
+  }
+  expirations = 0;
+  const u32 busy_iterations = perf_idle_count(WINDOW_MS);
+  const u32 busy_expirations = expirations;
+  for (usize i = 0; i < TIMER_COUNT; ++i) {
+    timer_cancel(&timers[i]);
+  }
+
+  const u32 ticks = WINDOW_MS * 1000 / WHEEL_TICK;
+  const u64 lost_ns =
+      perf_idle_lost_ns(idle_iterations, busy_iterations, WINDOW_MS);
+  printf("%u timers, %u expirations in %u ticks\n", TIMER_COUNT,
+         busy_expirations, ticks);
+  printf("wheel cost: %u ns per tick, %u ns per expiration\n",
+         (usize)(lost_ns / ticks),
+         busy_expirations ? (usize)(lost_ns / busy_expirations) : 0);
+}
+
+void loop(void) {}
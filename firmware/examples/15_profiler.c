@@ -0,0 +1,49 @@
+#include <hal/perf.h>
+#include <hal/time.h>
+#include <stdio.h>
+
+#define WORKLOAD_MS 2000
+
+extern u8 __sdram_start;
+extern u8 __sdram_text_end;
+
+static struct PerfCounter checksum_counter = PERF_COUNTER(checksum);
+static struct PerfCounter print_counter = PERF_COUNTER(print);
+
+u32 checksum(const u8 *const data, const usize length) {
+  u32 sum = 0;
+  for (usize i = 0; i < length; ++i) {
+    sum = (sum << 5) + sum + data[i];
+  }
+  return sum;
+}
+
+u32 fibonacci(const u32 n) {
+  return n < 2 ? n : fibonacci(n - 1) + fibonacci(n - 2);
+}
+
+void setup(void) {
+  // Buckets start at address 0 and extend over the code in SDRAM as well,
+  // so that images executing from SDRAM are profiled too
+  u32 *const histogram = (u32 *)&__sdram_start;
+  const usize buckets = (ptr)&__sdram_text_end >> 2;
+  perf_profile_start(histogram, buckets);
+
+  const u32 start = millis32();
+  u32 result = 0;
+  while (millis32() - start < WORKLOAD_MS) {
+    PERF_SCOPE(checksum_counter) {
+      result ^= checksum((const u8 *)0, 4096);
+    }
+    result ^= fibonacci(16);
+    PERF_SCOPE(print_counter) { printf("%08x\r", (usize)result); }
+  }
+
+  perf_profile_stop();
+  printf("\n");
+  perf_print(&checksum_counter);
+  perf_print(&print_counter);
+  perf_profile_dump();
+}
+
+void loop(void) {}
@@ -0,0 +1,55 @@
+#include <hal/perf.h>
+#include <stdio.h>
+
+#define TABLE_SIZE 1024
+#define ITERATIONS 100
+
+/* The same loop is placed in BRAM and in SDRAM and run over a table in
+ * each, so that the rows differ only in where instructions are fetched
+ * from and where the table is read from. Fetches and reads from SDRAM go
+ * through its 4 KiB cache, which the loop and the table each fit in after
+ * the first call, while together they evict each other's lines. The hits
+ * and misses per call show how much of the difference to BRAM comes from
+ * line fills. */
+
+static u32 bram_table[TABLE_SIZE] = {[0 ... TABLE_SIZE - 1] = 0x9E3779B9};
+__sdram_rodata static const u32 sdram_table[TABLE_SIZE] = {
+    [0 ... TABLE_SIZE - 1] = 0x9E3779B9};
+
+#define TABLE_SUM(_name, _placement)                                           \
+  _placement __attribute__((noinline)) u32 _name(const u32 *const table) {     \
+    u32 sum = 0;                                                               \
+    for (usize i = 0; i < TABLE_SIZE; ++i) {                                   \
+      sum = (sum << 3) + (sum ^ table[i]);                                     \
+    }                                                                          \
+    return sum;                                                                \
+  }
+
+TABLE_SUM(sum_bram, __fast)
+TABLE_SUM(sum_sdram, __sdram_text)
+
+static volatile u32 result;
+
+void measure(const char *const name, u32 (*const sum)(const u32 *const),
+             const u32 *const table) {
+  struct PerfCounter counter = {.name = name};
+  const u32 hits = perf_cache_hits();
+  const u32 misses = perf_cache_misses();
+  for (usize i = 0; i < ITERATIONS; ++i) {
+    PERF_SCOPE(counter) { result = sum(table); }
+  }
+  const u32 cpi = counter.cycles * 100 / counter.instret;
+  printf("%-26s %7u cycles, CPI %2u.%02u, %6u hits, %5u misses\n", name,
+         (usize)(counter.cycles / ITERATIONS), (usize)(cpi / 100),
+         (usize)(cpi % 100), (usize)((perf_cache_hits() - hits) / ITERATIONS),
+         (usize)((perf_cache_misses() - misses) / ITERATIONS));
+}
+
+void setup(void) {
+  measure("code BRAM,  table BRAM", sum_bram, bram_table);
+  measure("code BRAM,  table SDRAM", sum_bram, sdram_table);
+  measure("code SDRAM, table BRAM", sum_sdram, bram_table);
+  measure("code SDRAM, table SDRAM", sum_sdram, sdram_table);
+}
+
+void loop(void) {}
@@ -0,0 +1,68 @@
+#include <hal/perf.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PASSES 8
+#define MAX_SIZE 16384
+
+/* Working sets below the 4 KiB SDRAM cache are read from it after the first
+ * pass, larger ones miss on every line. Writes always go to SDRAM. */
+
+extern u8 __sdram_start;
+
+static volatile u32 result;
+
+static void print_rate(const char *const name, const usize size,
+                       const u32 cycles, const u32 hits, const u32 misses) {
+  const u32 rate = (u64)size * PASSES * 500 / cycles; // 50 MHz, in 0.1 MB/s
+  const u32 total = hits + misses ? hits + misses : 1;
+  printf("%-5s %5u B %4u.%u MB/s, %3u%% hits\n", name, size, rate / 10,
+         rate % 10, (usize)((u64)hits * 100 / total));
+}
+
+void measure(const usize size) {
+  u32 *const buffer = (u32 *)&__sdram_start;
+  u32 *const copy = buffer + MAX_SIZE / 4;
+  const usize words = size / 4;
+
+  u32 hits = perf_cache_hits();
+  u32 misses = perf_cache_misses();
+  u32 start = perf_cycles32();
+  for (usize pass = 0; pass < PASSES; ++pass) {
+    for (usize i = 0; i < words; ++i) {
+      buffer[i] = i;
+    }
+  }
+  print_rate("write", size, perf_cycles32() - start,
+             perf_cache_hits() - hits, perf_cache_misses() - misses);
+
+  hits = perf_cache_hits();
+  misses = perf_cache_misses();
+  start = perf_cycles32();
+  u32 sum = 0;
+  for (usize pass = 0; pass < PASSES; ++pass) {
+    for (usize i = 0; i < words; ++i) {
+      sum += buffer[i];
+    }
+  }
+  result = sum;
+  print_rate("read", size, perf_cycles32() - start, perf_cache_hits() - hits,
+             perf_cache_misses() - misses);
+
+  hits = perf_cache_hits();
+  misses = perf_cache_misses();
+  start = perf_cycles32();
+  for (usize pass = 0; pass < PASSES; ++pass) {
+    memcpy(copy, buffer, size);
+  }
+  print_rate("copy", size, perf_cycles32() - start, perf_cache_hits() - hits,
+             perf_cache_misses() - misses);
+}
+
+void setup(void) {
+  for (usize size = 1024; size <= MAX_SIZE; size *= 2) {
+    measure(size);
+  }
+}
+
+void loop(void) {}
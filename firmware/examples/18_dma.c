@@ -0,0 +1,71 @@
+#include <hal/dma.h>
+#include <hal/perf.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PASSES 8
+#define SIZE 4096
+
+/* The controller spends a read and a write per word, each followed by a cycle
+ * with the bus released, while a CPU copy also fetches its load, store and
+ * loop instructions. The CPU keeps running during a transfer. */
+
+extern u8 __sdram_start;
+
+static u32 bram_buffer[SIZE / 4];
+
+static const char message[] =
+    "This line was streamed to the UART by the DMA controller.\r\n";
+
+static void print_rate(const char *const name, const u32 cpu_cycles,
+                       const u32 dma_cycles) {
+  // 50 MHz, in 0.1 MB/s
+  const u32 cpu_rate = (u64)SIZE * PASSES * 500 / cpu_cycles;
+  const u32 dma_rate = (u64)SIZE * PASSES * 500 / dma_cycles;
+  printf("%-12s cpu %4u.%u MB/s, dma %4u.%u MB/s\n", name, cpu_rate / 10,
+         cpu_rate % 10, dma_rate / 10, dma_rate % 10);
+}
+
+static void measure(const char *const name, void *const destination,
+                    const void *const source) {
+  u32 start = perf_cycles32();
+  for (usize pass = 0; pass < PASSES; ++pass) {
+    memcpy(destination, source, SIZE);
+  }
+  const u32 cpu_cycles = perf_cycles32() - start;
+
+  memset(destination, 0, SIZE);
+  start = perf_cycles32();
+  for (usize pass = 0; pass < PASSES; ++pass) {
+    dma_memcpy(destination, source, SIZE);
+  }
+  const u32 dma_cycles = perf_cycles32() - start;
+
+  print_rate(name, cpu_cycles, dma_cycles);
+  if (memcmp(destination, source, SIZE) != 0) {
+    printf("%-12s copy mismatch\n", name);
+  }
+}
+
+void setup(void) {
+  u32 *const sdram_buffer = (u32 *)&__sdram_start;
+  u32 *const sdram_copy = sdram_buffer + SIZE / 4;
+  for (usize i = 0; i < SIZE / 4; ++i) {
+    bram_buffer[i] = i * 0x9E3779B9;
+  }
+  measure("bram->sdram", sdram_buffer, bram_buffer);
+  measure("sdram->bram", bram_buffer, sdram_buffer);
+  measure("sdram->sdram", sdram_copy, sdram_buffer);
+
+  // The CPU counts while the line is being sent
+  dma_uart_write_async(UART1, message, sizeof(message) - 1);
+  u32 spins = 0;
+  while (dma_get_busy()) {
+    ++spins;
+  }
+  dma_wait();
+  printf("%u iterations while streaming %u bytes\n", spins,
+         sizeof(message) - 1);
+}
+
+void loop(void) {}
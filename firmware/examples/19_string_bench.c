@@ -0,0 +1,76 @@
+#include <hal/perf.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BUFFER_SIZE 4096
+#define ITERATIONS 16
+
+/* Cycles per call of the string routines from string.S, for each size and
+ * source alignment with an aligned destination, in BRAM and in SDRAM. A
+ * plain byte loop is measured alongside memcpy as the baseline. */
+
+extern u8 __sdram_start;
+
+static u8 bram_buffer[2 * BUFFER_SIZE + 8] __attribute__((aligned(4)));
+
+static const usize sizes[] = {4, 16, 64, 256, 1024, 4096};
+
+static volatile usize result;
+
+// Kept from being turned back into a memcpy call
+__attribute__((noinline, optimize("no-tree-loop-distribute-patterns"))) void *
+byte_copy(void *const destination, const void *const source,
+          const usize length) {
+  u8 *dst = destination;
+  const u8 *src = source;
+  for (usize i = 0; i < length; ++i) {
+    dst[i] = src[i];
+  }
+  return destination;
+}
+
+#define MEASURE(_cycles, _call)                                                \
+  do {                                                                         \
+    const u32 __start = perf_cycles32();                                       \
+    for (usize __i = 0; __i < ITERATIONS; ++__i) {                             \
+      _call;                                                                   \
+    }                                                                          \
+    _cycles = (perf_cycles32() - __start) / ITERATIONS;                        \
+  } while (0)
+
+static void measure(const char *const name, u8 *const buffer) {
+  u8 *const dst = buffer;
+  u8 *const src = buffer + BUFFER_SIZE + 4;
+  for (usize i = 0; i < BUFFER_SIZE + 4; ++i) {
+    src[i] = 'a' + i % 26;
+  }
+
+  printf("%s\n%5s %5s %7s %7s %7s %7s %7s %7s\n", name, "size", "align",
+         "bytes", "memcpy", "memmove", "memset", "memcmp", "strlen");
+  for (usize s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+    const usize size = sizes[s];
+    for (usize align = 0; align < 4; ++align) {
+      u32 bytes, copy, move, set, cmp, len;
+      MEASURE(bytes, byte_copy(dst, src + align, size));
+      MEASURE(copy, memcpy(dst, src + align, size));
+      MEASURE(move, memmove(src + align + 4, src + align, size - 4));
+      MEASURE(set, memset(dst + align, 0x55, size));
+      memcpy(dst, src + align, size);
+      MEASURE(cmp, result = memcmp(dst, src + align, size));
+      // Terminates the string at the measured size
+      const u8 saved = src[align + size - 1];
+      src[align + size - 1] = '\0';
+      MEASURE(len, result = strlen((const char *)src + align));
+      src[align + size - 1] = saved;
+      printf("%5u %5u %7u %7u %7u %7u %7u %7u\n", size, align, bytes, copy,
+             move, set, cmp, len);
+    }
+  }
+}
+
+void setup(void) {
+  measure("BRAM", bram_buffer);
+  measure("SDRAM", &__sdram_start);
+}
+
+void loop(void) {}
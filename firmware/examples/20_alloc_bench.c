@@ -0,0 +1,105 @@
+#include <hal/mem.h>
+#include <hal/perf.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define OBJECTS 64
+#define OBJECT_SIZE 24
+#define ROUNDS 16
+#define ARENA_SIZE (OBJECTS * 32)
+
+/* Average cycles to allocate and release a batch of small objects with
+ * newlib malloc, a fixed-block pool and an arena. Releases are interleaved
+ * in the second pattern, which leaves malloc with a fragmented free list. */
+
+static MEM_POOL_BUFFER(pool_buffer, OBJECT_SIZE, OBJECTS);
+static struct MemPool pool;
+
+static u64 arena_buffer[ARENA_SIZE / 8];
+static struct MemArena arena;
+
+static void *objects[OBJECTS];
+
+// Even objects first and odd ones after them, when interleaved
+static usize release_index(const usize i, const bool interleaved) {
+  return interleaved ? (i * 2 + i / (OBJECTS / 2)) % OBJECTS : i;
+}
+
+static void print_result(const char *const name, const u32 alloc_cycles,
+                         const u32 free_cycles) {
+  printf("%-16s alloc %4u cycles, free %4u cycles\n", name,
+         alloc_cycles / (ROUNDS * OBJECTS), free_cycles / (ROUNDS * OBJECTS));
+}
+
+static void measure_malloc(const bool interleaved) {
+  u32 alloc_cycles = 0, free_cycles = 0;
+  for (usize round = 0; round < ROUNDS; ++round) {
+    u32 start = perf_cycles32();
+    for (usize i = 0; i < OBJECTS; ++i) {
+      objects[i] = malloc(OBJECT_SIZE);
+    }
+    alloc_cycles += perf_cycles32() - start;
+    start = perf_cycles32();
+    for (usize i = 0; i < OBJECTS; ++i) {
+      free(objects[release_index(i, interleaved)]);
+    }
+    free_cycles += perf_cycles32() - start;
+  }
+  print_result(interleaved ? "malloc shuffled" : "malloc", alloc_cycles,
+               free_cycles);
+}
+
+static void measure_pool(const bool interleaved) {
+  u32 alloc_cycles = 0, free_cycles = 0;
+  for (usize round = 0; round < ROUNDS; ++round) {
+    u32 start = perf_cycles32();
+    for (usize i = 0; i < OBJECTS; ++i) {
+      objects[i] = mem_pool_alloc(&pool);
+    }
+    alloc_cycles += perf_cycles32() - start;
+    start = perf_cycles32();
+    for (usize i = 0; i < OBJECTS; ++i) {
+      mem_pool_free(&pool, objects[release_index(i, interleaved)]);
+    }
+    free_cycles += perf_cycles32() - start;
+  }
+  print_result(interleaved ? "pool shuffled" : "pool", alloc_cycles,
+               free_cycles);
+}
+
+static void measure_arena(void) {
+  u32 alloc_cycles = 0, free_cycles = 0;
+  for (usize round = 0; round < ROUNDS; ++round) {
+    u32 start = perf_cycles32();
+    MEM_ARENA_SCOPE(arena) {
+      for (usize i = 0; i < OBJECTS; ++i) {
+        objects[i] = mem_arena_alloc(&arena, OBJECT_SIZE);
+      }
+      alloc_cycles += perf_cycles32() - start;
+      start = perf_cycles32();
+    }
+    free_cycles += perf_cycles32() - start;
+  }
+  print_result("arena", alloc_cycles, free_cycles);
+}
+
+void setup(void) {
+  mem_pool_init(&pool, pool_buffer, OBJECT_SIZE, OBJECTS);
+  mem_arena_init(&arena, arena_buffer, sizeof(arena_buffer));
+
+  measure_malloc(false);
+  measure_malloc(true);
+  measure_pool(false);
+  measure_pool(true);
+  measure_arena();
+
+  // The heap ends short of the stack instead of growing into it
+  usize blocks = 0;
+  while (malloc(1024) != NULLPTR) {
+    ++blocks;
+  }
+  printf("heap exhausted after %u KiB, %u bytes left\n", blocks,
+         mem_heap_free());
+}
+
+void loop(void) {}
@@ -0,0 +1,69 @@
+#include <hal/display.h>
+#include <hal/perf.h>
+#include <hal/time.h>
+#include <stdio.h>
+
+#define FRAMES 16
+
+/* A frame drawn pixel by pixel into the matrix registers, as 05 does, costs
+ * a bitfield read-modify-write of every pixel, while the packed framebuffer
+ * is drawn with word operations in RAM and flushed with seven stores. */
+
+extern volatile struct PIXEL __gpio_disp[DISP_COLS][DISP_ROWS];
+
+static const struct PIXEL pixel_colors[] = {
+    {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 0}};
+
+static void draw_pixels(const usize frame) {
+  for (usize x = 0; x < DISP_COLS; ++x) {
+    for (usize y = 0; y < DISP_ROWS; ++y) {
+      __gpio_disp[x][y] = pixel_colors[(x + frame) / 2 % 4];
+    }
+  }
+}
+
+static const enum DISP_COLOR colors[] = {DISP_RED, DISP_GREEN, DISP_BLUE,
+                                         DISP_YELLOW};
+
+static void draw_framebuffer(struct Framebuffer *const fb, const usize frame) {
+  for (usize x = 0; x < DISP_COLS; ++x) {
+    disp_fill_col(fb, x, colors[(x + frame) / 2 % 4]);
+  }
+}
+
+void setup(void) {
+  struct PerfCounter pixels = {.name = "pixel registers"};
+  for (usize frame = 0; frame < FRAMES; ++frame) {
+    PERF_SCOPE(pixels) { draw_pixels(frame); }
+  }
+
+  // Waiting for the swap is left out, to count only the drawing and stores
+  struct Framebuffer fb;
+  struct PerfCounter packed = {.name = "packed framebuffer"};
+  for (usize frame = 0; frame < FRAMES; ++frame) {
+    while (disp_get_swap_pending())
+      ;
+    PERF_SCOPE(packed) {
+      draw_framebuffer(&fb, frame);
+      disp_flush(&fb);
+    }
+  }
+
+  printf("%-20s %6u cycles per frame\n", pixels.name,
+         (usize)(pixels.cycles / FRAMES));
+  printf("%-20s %6u cycles per frame\n", packed.name,
+         (usize)(packed.cycles / FRAMES));
+}
+
+void loop(void) {
+  static usize frame;
+  static struct Framebuffer fb;
+  static struct Framebuffer sprite = {.red = 0x0000001818000000ull,
+                                      .green = 0x0000003C3C000000ull};
+  disp_clear(&fb, DISP_BLUE);
+  disp_fill_row(&fb, frame % DISP_ROWS, DISP_BLACK);
+  disp_blit(&fb, &sprite, (isize)(frame % 8) - 4, 0);
+  disp_flush(&fb);
+  ++frame;
+  sleep(100);
+}
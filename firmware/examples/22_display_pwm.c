@@ -0,0 +1,39 @@
+#include <hal/display.h>
+#include <hal/perf.h>
+#include <hal/time.h>
+#include <stdio.h>
+
+/* Red and blue gradients across the matrix, with a green bar fading in and
+ * out over them. The brightness of every channel is modulated by the
+ * display refresh, so each frame only costs drawing and 24 stores. */
+
+static struct PwmFramebuffer fb;
+
+static void draw(const usize frame) {
+  for (usize y = 0; y < DISP_ROWS; ++y) {
+    for (usize x = 0; x < DISP_COLS; ++x) {
+      disp_pwm_set_pixel(&fb, x, y, DISP_RGB12(x * 2 + 1, 0, y * 2 + 1));
+    }
+  }
+  const usize level = frame % 30 < 15 ? frame % 30 : 30 - frame % 30;
+  disp_pwm_fill_rect(&fb, 0, frame / 30 % DISP_ROWS, DISP_COLS, 1,
+                     DISP_RGB12(0, level, 0));
+}
+
+void setup(void) {
+  disp_set_pwm(true);
+
+  struct PerfCounter counter = {.name = "12 bit frame"};
+  PERF_SCOPE(counter) {
+    draw(0);
+    disp_pwm_flush(&fb);
+  }
+  printf("%-20s %6u cycles\n", counter.name, (usize)counter.cycles);
+}
+
+void loop(void) {
+  static usize frame;
+  draw(frame++);
+  disp_pwm_flush(&fb);
+  sleep(20);
+}
@@ -0,0 +1,55 @@
+#include <hal/defer.h>
+#include <hal/irq.h>
+#include <hal/time.h>
+#include <stdio.h>
+
+#define TICK_US 20000
+#define PHASE_MS 2000
+
+/* Worst-case time with interrupts masked while a timer handler reports
+ * every tick, first by printing from the handler and then by posting the
+ * print to the deferred work queue, which the main loop drains. Build it
+ * with `make DEFINES=-DIRQ_MASKED_STATS=true` for the measurement. */
+
+_Static_assert(IRQ_MASKED_STATS, "IRQ_MASKED_STATS is not set");
+
+static volatile usize ticks;
+
+static void print_tick(const void *const argument) {
+  printf("tick %u\n", (usize)argument);
+}
+
+static void tick_printing(const usize irq, union StackFrame *const frame) {
+  print_tick((const void *)++ticks);
+}
+
+static void tick_deferring(const usize irq, union StackFrame *const frame) {
+  defer_post(print_tick, (const void *)++ticks);
+}
+
+static u32 measure(const irq_fn handler) {
+  irq_set_handler(IRQ_TIMER0, handler);
+  irq_reset_masked_max();
+  const u64 end = millis() + PHASE_MS;
+  while (millis() < end) {
+    defer_run();
+  }
+  return irq_get_masked_max();
+}
+
+void setup(void) {
+  timer_set_interval(TIMER0, TICK_US);
+  irq_set_enabled(irq_get_enabled() | IRQ_TIMER0);
+  timer_set_enabled(TIMER0, true);
+
+  const u32 printing = measure(tick_printing);
+  const u32 deferring = measure(tick_deferring);
+
+  timer_set_enabled(TIMER0, false);
+  defer_run();
+  printf("handler printing   %7u cycles masked at most\n", printing);
+  printf("handler deferring  %7u cycles masked at most\n", deferring);
+  printf("dropped calls      %7u\n", defer_get_dropped());
+}
+
+void loop(void) {}
@@ -0,0 +1,85 @@
+#include <hal/irq.h>
+#include <hal/time.h>
+#include <stdio.h>
+
+#define TICK_US 10000
+#define SLOW_US 2000
+#define PHASE_MS 3000
+#define CYCLES_PER_BYTE 250 // 10 bits at 2 Mbaud and 50 MHz
+
+/* Worst-case latency of a UART1 RX handler while a slow TIMER0 handler of
+ * a lower priority runs, first with every IRQ masked during it and then
+ * with the timer handler nested. Stream data into UART1 while it runs, e.g.
+ * `cat /dev/urandom > /dev/ttyUSB1` with the port set to 2000000 baud.
+ * The deepest FIFO level found on entry bounds the time since the first
+ * byte arrived. Build it with `make DEFINES=-DIRQ_MASKED_STATS=true` for
+ * the masked time. */
+
+_Static_assert(IRQ_MASKED_STATS, "IRQ_MASKED_STATS is not set");
+
+#define UART_LEVEL_MASK 0xFFFF
+#define UART_LEVEL_OVERRUN (1 << 31)
+
+extern const volatile u8 __uart1_rx;
+extern const volatile usize __uart1_rx_level;
+
+static volatile usize level_max;
+static volatile usize overruns;
+static volatile u32 received;
+
+static void slow_handler(const usize irqs, union StackFrame *const frame) {
+  const u32 start = micros32();
+  while (micros32() - start < SLOW_US) {
+  }
+}
+
+static __fast void rx_handler(const usize irqs,
+                              union StackFrame *const frame) {
+  const usize level = __uart1_rx_level;
+  if (level & UART_LEVEL_OVERRUN) {
+    ++overruns;
+  }
+  usize count = level & UART_LEVEL_MASK;
+  if (count > level_max) {
+    level_max = count;
+  }
+  received += count;
+  for (; count > 0; --count) {
+    (void)__uart1_rx;
+  }
+}
+
+static void measure(const char *const name, const bool nested) {
+  irq_set_nested(IRQ_TIMER0, nested);
+  level_max = overruns = received = 0;
+  irq_reset_masked_max();
+  const u64 end = millis() + PHASE_MS;
+  while (millis() < end) {
+  }
+  const usize latency = level_max > 1 ? (level_max - 1) * CYCLES_PER_BYTE : 0;
+  printf("%-8s RX latency %6u cycles, %6u bytes, %3u overruns, "
+         "masked %6u cycles\n",
+         name, latency, (usize)received, (usize)overruns,
+         (usize)irq_get_masked_max());
+}
+
+void setup(void) {
+  irq_set_handler(IRQ_TIMER0, slow_handler);
+  irq_set_priority(IRQ_TIMER0, IRQ_PRIORITY_LOW);
+  irq_set_handler(IRQ_UART_RX_READY, rx_handler);
+  irq_set_handler(IRQ_UART_RX_THRESHOLD, rx_handler);
+  irq_set_priority(IRQ_UART_RX_READY | IRQ_UART_RX_THRESHOLD,
+                   IRQ_PRIORITY_HIGH);
+
+  timer_set_interval(TIMER0, TICK_US);
+  irq_set_enabled(irq_get_enabled() | IRQ_TIMER0 | IRQ_UART_RX_READY |
+                  IRQ_UART_RX_THRESHOLD);
+  timer_set_enabled(TIMER0, true);
+
+  measure("masked", false);
+  measure("nested", true);
+
+  timer_set_enabled(TIMER0, false);
+}
+
+void loop(void) {}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <hal/types.h>
+
+/* Count trailing zeros using a de Bruijn sequence, since RV32IM has no
+ * bit manipulation instructions. Result is undefined for zero. */
+static inline usize bits_ctz(const usize value) {
+  static const u8 DE_BRUIJN_INDEX[32] = {
+      0,  1,  28, 2,  29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4,  8,
+      31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6,  11, 5,  10, 9,
+  };
+  return DE_BRUIJN_INDEX[((value & -value) * 0x077CB531u) >> 27];
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <hal/types.h>
+
+#ifndef DEFER_QUEUE_SIZE
+#define DEFER_QUEUE_SIZE 32 // pending calls, a power of two
+#endif
+
+#ifndef DEFER_STACK_SIZE
+#define DEFER_STACK_SIZE 2048 // worker thread stack, with room for printf
+#endif
+
+typedef void (*defer_fn)(const void *const);
+
+/* Calls posted by interrupt handlers to run later with interrupts enabled,
+ * so slow work such as printing does not mask every other IRQ. Handlers
+ * which can not be preempted post without a lock, as the only producer
+ * running. Threads and nested handlers may be preempted by a handler which
+ * posts as well, so they mask every IRQ through irq_lock for the few
+ * instructions of a post, which is the cost of allowing nested handlers.
+ * Calls run in posting order, after every loop() of main or in a worker
+ * thread, which is woken by each post. Returns false if the queue was
+ * full. */
+bool defer_post(const defer_fn function,
+                const void *const argument); // handler safe
+
+/* Runs the pending calls, including ones posted meanwhile, and returns
+ * their count. Does nothing inside a handler or while another caller is
+ * draining the queue. */
+usize defer_run(void);
+
+/* Drains the queue in a thread of its own priority, for firmware whose
+ * loop() blocks or runs too long between calls */
+isize defer_start_thread(const usize priority);
+
+usize defer_get_pending(void);
+usize defer_get_dropped(void);
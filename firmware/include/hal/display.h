@@ -0,0 +1,84 @@
+#pragma once
+
+#include <hal/gpio.h>
+#include <hal/types.h>
+
+/* Colors are the red, green and blue bits of struct PIXEL */
+enum DISP_COLOR {
+  DISP_BLACK = 0b000,
+  DISP_RED = 0b001,
+  DISP_GREEN = 0b010,
+  DISP_YELLOW = 0b011,
+  DISP_BLUE = 0b100,
+  DISP_MAGENTA = 0b101,
+  DISP_CYAN = 0b110,
+  DISP_WHITE = 0b111,
+};
+
+/* Off-screen framebuffer of the LED matrix, packed as one bit-plane per
+ * color. Pixel (x, y) is bit y * 8 + x, where x and y are the first and
+ * second index of the pixel registers, so every row is a byte and drawing
+ * touches whole words instead of single pixels. */
+struct Framebuffer {
+  u64 red;
+  u64 green;
+  u64 blue;
+};
+
+void disp_clear(struct Framebuffer *const fb, const enum DISP_COLOR color);
+void disp_set_pixel(struct Framebuffer *const fb, const usize x, const usize y,
+                    const enum DISP_COLOR color);
+enum DISP_COLOR disp_get_pixel(const struct Framebuffer *const fb,
+                               const usize x, const usize y);
+
+/* Rectangles are clipped to the matrix */
+void disp_fill_rect(struct Framebuffer *const fb, const usize x, const usize y,
+                    const usize width, const usize height,
+                    const enum DISP_COLOR color);
+void disp_fill_row(struct Framebuffer *const fb, const usize y,
+                   const enum DISP_COLOR color);
+void disp_fill_col(struct Framebuffer *const fb, const usize x,
+                   const enum DISP_COLOR color);
+
+/* Draws the source shifted by (dx, dy), clipping whatever leaves the
+ * matrix. Black source pixels are transparent. */
+void disp_blit(struct Framebuffer *const fb, const struct Framebuffer *const src,
+               const isize dx, const isize dy);
+
+/* Writes the planes into the hardware back buffer with six stores and
+ * swaps it in at the end of the current multiplexed frame. A flush waits
+ * for the previous swap, which paces updates to the refresh rate. */
+void disp_flush(const struct Framebuffer *const fb);
+bool disp_get_swap_pending(void);
+
+/* Builds a 12 bit pixel out of 4 bit red, green and blue intensities */
+#define DISP_RGB12(_r, _g, _b)                                                 \
+  ((u16)(((_r) & 0xF) << 8 | ((_g) & 0xF) << 4 | ((_b) & 0xF)))
+
+/* Framebuffer of the 4 bit per channel mode, in the layout of the hardware.
+ * Each row is three words of eight packed 0xRGB pixels, pixel x of the row
+ * at bit 12 * x, so a flush is a plain copy. The refresh shows intensity
+ * bit k for 2^k sixteenths of a row period, without any help of the CPU. */
+struct PwmFramebuffer {
+  u32 words[DISP_ROWS * 3];
+};
+
+/* Selects between the 1 bit planes and the 12 bit pixels. Both are double
+ * buffered behind the same swap, so either flush shows its own buffer. */
+void disp_set_pwm(const bool enable);
+bool disp_get_pwm(void);
+
+void disp_pwm_clear(struct PwmFramebuffer *const fb, const u16 rgb);
+void disp_pwm_set_pixel(struct PwmFramebuffer *const fb, const usize x,
+                        const usize y, const u16 rgb);
+u16 disp_pwm_get_pixel(const struct PwmFramebuffer *const fb, const usize x,
+                       const usize y);
+
+/* Rectangles are clipped to the matrix */
+void disp_pwm_fill_rect(struct PwmFramebuffer *const fb, const usize x,
+                        const usize y, const usize width, const usize height,
+                        const u16 rgb);
+
+/* Writes all 24 words into the hardware back buffer and swaps it in at the
+ * end of the current frame, waiting for the previous swap like disp_flush */
+void disp_pwm_flush(const struct PwmFramebuffer *const fb);
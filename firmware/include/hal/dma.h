@@ -0,0 +1,24 @@
+#pragma once
+
+#include <hal/types.h>
+#include <hal/uart.h>
+
+/* A single transfer is in flight at a time, sharing the bus with the CPU
+ * access by access. Starting one while another is running waits for it. */
+
+/* Copies move whole words, so the bulk is handed to DMA only when source and
+ * destination share their alignment. Unaligned ends are copied by the CPU. */
+void dma_memcpy(void *const destination, const void *const source,
+                const usize length);
+void dma_memcpy_async(void *const destination, const void *const source,
+                      const usize length);
+
+/* Bytes are pushed straight into the transmit FIFO, bypassing the software
+ * buffer of put_buff_async, so that one should be drained first. */
+void dma_uart_write(const enum UART_PORT port, const char *const buffer,
+                    const usize length);
+void dma_uart_write_async(const enum UART_PORT port, const char *const buffer,
+                          const usize length);
+
+bool dma_get_busy(void);
+void dma_wait(void);
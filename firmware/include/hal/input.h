@@ -0,0 +1,41 @@
+#pragma once
+
+#include <hal/gpio.h>
+#include <hal/types.h>
+
+/* Buttons and switches are debounced in hardware, which queues every change
+ * with the microsecond counter of the moment it settled. Inputs are numbered
+ * like the bits of the button and switch register. */
+enum INPUT {
+  INPUT_SW0 = 0,
+  INPUT_SW7 = 7,
+  INPUT_BTN_UP = 8,
+  INPUT_BTN_DOWN = 9,
+  INPUT_BTN_LEFT = 10,
+  INPUT_BTN_RIGHT = 11,
+  INPUT_BTN_CENTER = 12,
+};
+
+struct InputEvent {
+  enum INPUT input;
+  enum DIGITAL_STATE state;
+  u32 micros;   // lower half of the runtime counter
+  bool overrun; // events were dropped before this one
+};
+
+/* Takes the oldest event without blocking, false if there is none. The
+ * event and its time are two reads, so one context should poll at a time. */
+bool input_poll_event(struct InputEvent *const event);
+
+static inline bool input_is_button(const enum INPUT input) {
+  return input >= INPUT_BTN_UP;
+}
+
+static inline enum BUTTON input_get_button(const enum INPUT input) {
+  return (enum BUTTON)(1 << (input - INPUT_BTN_UP));
+}
+
+/* A change is accepted once the input held it for this long, 5 ms by
+ * default and at most 65535 us */
+void input_set_debounce(const u32 interval_us);
+u32 input_get_debounce(void);
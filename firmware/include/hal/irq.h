@@ -2,6 +2,10 @@
 
 #include <hal/types.h>
 
+#ifndef IRQ_MASKED_STATS
+#define IRQ_MASKED_STATS false // time the handlers of every interrupt
+#endif
+
 #define IRQ_COUNT 32
 #define IRQ_UNSET (irq_fn)0xFFFFFFFF
 
@@ -22,6 +26,7 @@ union StackFrame {
 };
 
 typedef void (*irq_fn)(const usize, union StackFrame *const);
+typedef void (*irq_switch_fn)(union StackFrame *const);
 
 enum IRQ {
   IRQ_NONE = 0,
@@ -34,13 +39,71 @@ enum IRQ {
   IRQ_TIMER3 = 1 << 7,
   IRQ_UART_RX_READY = 1 << 8,
   IRQ_UART_TX_READY = 1 << 9,
+  IRQ_UART_RX_THRESHOLD = 1 << 10,
+  IRQ_UART_TX_THRESHOLD = 1 << 11,
+  IRQ_DMA = 1 << 12,
+  IRQ_UART_RX_IDLE = 1 << 13,
   IRQ_BUTTON_EVENT = 1 << 30,
   IRQ_SWITCH_EVENT = 1 << 31,
   IRQ_ALL = 0xFFFFFFFF,
 };
 
+/* Handlers registered with IRQ_FRAME_CALLER_SAVED are entered through a
+ * fast path which only spills caller-saved registers, and receive NULLPTR as
+ * their stack frame unless another pending handler requires a full frame. */
+enum IRQ_FRAME {
+  IRQ_FRAME_CALLER_SAVED,
+  IRQ_FRAME_FULL,
+};
+
+/* Pending IRQs are dispatched from the highest priority down, and in
+ * ascending IRQ number within the same priority. */
+enum IRQ_PRIORITY {
+  IRQ_PRIORITY_LOW,
+  IRQ_PRIORITY_NORMAL,
+  IRQ_PRIORITY_HIGH,
+  IRQ_PRIORITY_CRITICAL,
+  IRQ_PRIORITY_COUNT,
+};
+
+/* Nested handlers run outside of interrupt mode, with the IRQs of a higher
+ * priority enabled so they preempt them on the same stack. IRQs of handlers
+ * with a full frame are left masked, as are the ones of the same or lower
+ * priority, which wait until the nested handler returns. */
+void irq_set_nested(const enum IRQ mask, const bool nested);
+bool irq_get_nested(const enum IRQ irq);
+
+/* Masks every IRQ for code shared by threads and handlers. Handlers which
+ * can not be preempted skip it, while nested ones take it like a thread. */
+usize irq_lock(void);
+void irq_unlock(const usize state);
+
+/* A handler may request a switch, which runs after all pending handlers
+ * have returned. Interrupts taken through the fast path are re-entered with
+ * a full frame first, so the switch handler can redirect the frame. */
+void irq_set_switch_handler(const irq_switch_fn handler);
+void irq_request_switch(void);
+bool irq_get_active(void);
+
+/* Longest time in cycles which the handlers of a single interrupt took,
+ * while every other IRQ was masked. The entry and exit code, and a switch
+ * requested by the handlers, come on top of it. Nested handlers run with
+ * IRQs enabled and are left out, while the handlers which preempt them are
+ * measured as interrupts of their own. Only measured with IRQ_MASKED_STATS
+ * set, as it adds to the dispatch of every interrupt. */
+u32 irq_get_masked_max(void);
+void irq_reset_masked_max(void);
+
 usize irq_set_enabled(const enum IRQ mask);
 usize irq_get_enabled(void);
 void irq_wait(const enum IRQ mask);
 void irq_set_handler(const enum IRQ irq, const irq_fn handler);
+void irq_set_handler_frame(const enum IRQ irq, const irq_fn handler,
+                           const enum IRQ_FRAME frame);
+void irq_set_priority(const enum IRQ mask, const enum IRQ_PRIORITY priority);
+enum IRQ_PRIORITY irq_get_priority(const enum IRQ irq);
 bool irq_ecall(void);
+
+/* Raises IRQ_INT_TIMER once after the given number of cycles, or never if
+ * zero. Returns the cycles which were left on the previous countdown. */
+usize irq_set_timer(const usize cycles);
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <hal/types.h>
+
+#ifndef MEM_HEAP_SDRAM
+#define MEM_HEAP_SDRAM false // place the malloc heap in free SDRAM
+#endif
+
+#ifndef MEM_STACK_RESERVE
+#define MEM_STACK_RESERVE 0x1000 // bytes of the BRAM stack kept from the heap
+#endif
+
+#define MEM_ALIGN 8 // alignment of arena allocations, as malloc guarantees
+
+/* The malloc heap grows from __stack_end towards the main stack and stops
+ * MEM_STACK_RESERVE bytes short of its top, or spans the SDRAM from
+ * __sdram_start when MEM_HEAP_SDRAM is set. Exhausting it makes malloc
+ * return NULLPTR instead of overwriting the stack. */
+usize mem_heap_used(void);
+usize mem_heap_free(void);
+
+/* Fixed-size blocks with O(1) allocation and release, safe to use from
+ * handlers. Blocks are carved from the buffer on first use, so a pool is
+ * initialized in constant time, and released ones are linked through their
+ * first word. */
+struct MemPool {
+  void *free;
+  u8 *next;
+  u8 *end;
+  usize block_size;
+  usize used;
+};
+
+#define MEM_POOL_BLOCK(_size)                                                  \
+  ((((_size) < sizeof(void *) ? sizeof(void *) : (_size)) + 3) & ~3)
+
+/* Statically allocated storage for a pool of _count objects of _size bytes */
+#define MEM_POOL_BUFFER(_name, _size, _count)                                  \
+  u32 _name[MEM_POOL_BLOCK(_size) / 4 * (_count)]
+
+void mem_pool_init(struct MemPool *const pool, void *const buffer,
+                   const usize block_size, const usize count);
+void *mem_pool_alloc(struct MemPool *const pool);
+void mem_pool_free(struct MemPool *const pool, void *const block);
+usize mem_pool_used(const struct MemPool *const pool);
+
+/* Bump allocators for data released all at once, either entirely or back to
+ * a mark. They are not locked, so each arena should have a single owner.
+ *   MEM_ARENA_SCOPE(arena) { ... }
+ * releases everything allocated inside the block when it is left normally,
+ * while break, return or goto leave the allocations in place. */
+struct MemArena {
+  u8 *start;
+  u8 *next;
+  u8 *end;
+};
+
+struct MemArenaScope {
+  struct MemArena *arena;
+  u8 *mark;
+};
+
+#define MEM_ARENA_SCOPE(_arena)                                                \
+  for (struct MemArenaScope __arena_scope = {&(_arena), (_arena).next};        \
+       __arena_scope.arena != NULLPTR; mem_arena_scope_end(&__arena_scope))
+
+void mem_arena_init(struct MemArena *const arena, void *const buffer,
+                    const usize size);
+void *mem_arena_alloc(struct MemArena *const arena, const usize size);
+void mem_arena_reset(struct MemArena *const arena);
+usize mem_arena_used(const struct MemArena *const arena);
+
+static inline void mem_arena_scope_end(struct MemArenaScope *const scope) {
+  scope->arena->next = scope->mark;
+  scope->arena = NULLPTR;
+}
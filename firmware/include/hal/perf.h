@@ -0,0 +1,119 @@
+#pragma once
+
+#include <hal/types.h>
+
+#ifndef PERF_SAMPLE_PERIOD
+#define PERF_SAMPLE_PERIOD 49999 // profiler sampling period in cycles
+#endif
+
+/* Counter CSRs are read with .insn, since rv32im without Zicsr does not
+ * accept rdcycle and friends. Immediates are the sign-extended CSR numbers. */
+#define PERF_CSR_CYCLE (0xC00 - 0x1000)
+#define PERF_CSR_INSTRET (0xC02 - 0x1000)
+#define PERF_CSR_CYCLEH (0xC80 - 0x1000)
+#define PERF_CSR_INSTRETH (0xC82 - 0x1000)
+
+#define perf_csr_read(csr)                                                     \
+  ({                                                                           \
+    u32 __value;                                                               \
+    __asm__ volatile(".insn i 0x73, 2, %0, x0, %1"                             \
+                     : "=r"(__value)                                           \
+                     : "i"(csr));                                              \
+    __value;                                                                   \
+  })
+
+static inline u32 perf_cycles32(void) { return perf_csr_read(PERF_CSR_CYCLE); }
+
+static inline u32 perf_instret32(void) {
+  return perf_csr_read(PERF_CSR_INSTRET);
+}
+
+static inline u64 perf_cycles(void) {
+  u32 high, low;
+  do {
+    high = perf_csr_read(PERF_CSR_CYCLEH);
+    low = perf_csr_read(PERF_CSR_CYCLE);
+  } while (high != perf_csr_read(PERF_CSR_CYCLEH));
+  return (u64)high << 32 | low;
+}
+
+static inline u64 perf_instret(void) {
+  u32 high, low;
+  do {
+    high = perf_csr_read(PERF_CSR_INSTRETH);
+    low = perf_csr_read(PERF_CSR_INSTRET);
+  } while (high != perf_csr_read(PERF_CSR_INSTRETH));
+  return (u64)high << 32 | low;
+}
+
+extern const volatile u32 __cache_hits;
+extern const volatile u32 __cache_misses;
+
+/* Reads from SDRAM that hit or missed the cache since reset. Writes are not
+ * counted, and both counters wrap around. */
+static inline u32 perf_cache_hits(void) { return __cache_hits; }
+
+static inline u32 perf_cache_misses(void) { return __cache_misses; }
+
+struct PerfCounter {
+  const char *name;
+  u32 calls;
+  u64 cycles;
+  u64 instret;
+  u32 cycles_max;
+};
+
+struct PerfScope {
+  struct PerfCounter *counter;
+  u32 cycles;
+  u32 instret;
+};
+
+#define PERF_COUNTER(_name) {.name = #_name}
+
+/* Measures the following statement or block:
+ *   PERF_SCOPE(counter) { ... }
+ * Leaving the block with break, return or goto skips the measurement. */
+#define PERF_SCOPE(_counter)                                                   \
+  for (struct PerfScope __perf_scope = perf_scope_begin(&(_counter));          \
+       __perf_scope.counter != NULLPTR; perf_scope_end(&__perf_scope))
+
+static inline struct PerfScope perf_scope_begin(struct PerfCounter *counter) {
+  return (struct PerfScope){
+      .counter = counter,
+      .cycles = perf_cycles32(),
+      .instret = perf_instret32(),
+  };
+}
+
+static inline void perf_scope_end(struct PerfScope *const scope) {
+  const u32 cycles = perf_cycles32() - scope->cycles;
+  const u32 instret = perf_instret32() - scope->instret;
+  struct PerfCounter *const counter = scope->counter;
+  ++counter->calls;
+  counter->cycles += cycles;
+  counter->instret += instret;
+  if (cycles > counter->cycles_max) {
+    counter->cycles_max = cycles;
+  }
+  scope->counter = NULLPTR;
+}
+
+void perf_print(const struct PerfCounter *const counter);
+void perf_reset(struct PerfCounter *const counter);
+
+/* Overhead of periodic interrupts, measured by counting iterations of an
+ * idle loop over a window in milliseconds. A count taken with the interrupt
+ * source disabled is the baseline, and the iterations missing from a count
+ * taken with it enabled are converted into the nanoseconds spent in it. */
+u32 perf_idle_count(const u32 window_ms);
+u64 perf_idle_lost_ns(const u32 baseline, const u32 iterations,
+                      const u32 window_ms);
+
+/* The profiler samples the interrupted program counter every
+ * PERF_SAMPLE_PERIOD cycles into one bucket per instruction of the
+ * firmware image. Samples are delayed while interrupts are masked, and
+ * interrupt handlers are never sampled since they cannot be interrupted. */
+void perf_profile_start(u32 *const histogram, const usize buckets);
+void perf_profile_stop(void);
+void perf_profile_dump(void);
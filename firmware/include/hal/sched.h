@@ -0,0 +1,79 @@
+#pragma once
+
+#include <hal/irq.h>
+#include <hal/types.h>
+
+#ifndef SCHED_MAX_THREADS
+#define SCHED_MAX_THREADS 8 // including the main and idle threads
+#endif
+
+#ifndef SCHED_STACK_SIZE
+#define SCHED_STACK_SIZE 1024 // default stack size in bytes
+#endif
+
+#ifndef SCHED_TIME_SLICE
+#define SCHED_TIME_SLICE 1000 // round-robin interval in microseconds
+#endif
+
+/* Priority 0 is the highest. The lowest one is reserved for the idle
+ * thread, which waits for interrupts when no other thread is ready. */
+#define SCHED_PRIORITY_COUNT 32
+#define SCHED_PRIORITY_HIGHEST 0
+#define SCHED_PRIORITY_NORMAL 16
+#define SCHED_PRIORITY_IDLE (SCHED_PRIORITY_COUNT - 1)
+
+#define SCHED_NO_THREAD -1
+
+typedef void (*thread_fn)(const void *const);
+
+enum THREAD_STATE {
+  THREAD_UNUSED,
+  THREAD_READY,
+  THREAD_BLOCKED,
+};
+
+/* Blocked threads are kept in priority order, and in FIFO order within the
+ * same priority. */
+struct WaitQueue {
+  struct Thread *head;
+};
+
+/* Interrupt handlers run on the stack of the interrupted thread, so every
+ * stack has to leave room for the deepest handler. The frame is saved in
+ * place by the interrupt entry code through __irq_frame. */
+struct Thread {
+  union StackFrame frame;
+  struct Thread *next;
+  struct Thread *prev;
+  usize priority;
+  usize base_priority;
+  volatile usize state;
+  usize stack_size;
+  struct WaitQueue *wait_queue;
+  void *blocked_on;
+  usize mutex_count;
+};
+
+void sched_start(const usize main_priority);
+bool sched_get_started(void);
+usize sched_lock(void);
+void sched_unlock(const usize state);
+
+isize thread_create(const thread_fn entrypoint, const void *const argument,
+                    const usize priority, const usize stack_size);
+void thread_exit(void) __attribute__((noreturn));
+void thread_yield(void);
+isize thread_self(void);
+void thread_set_priority(const isize thread_id, const usize priority);
+usize thread_get_priority(const isize thread_id);
+
+/* Kernel interface for hal/sync.h, called with the scheduler locked. Blocking
+ * returns immediately before the scheduler starts or inside a handler, so
+ * callers always recheck their wait condition. Waking from a handler defers
+ * the switch until all pending handlers have returned. */
+struct Thread *sched_self(void);
+usize sched_block(struct WaitQueue *const queue, const usize state);
+struct Thread *sched_wake(struct WaitQueue *const queue);
+usize sched_wake_all(struct WaitQueue *const queue);
+void sched_set_priority(struct Thread *const thread, const usize priority);
+void sched_reschedule(void);
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <hal/sched.h>
+#include <hal/types.h>
+
+/* Waiting threads block on a wait queue instead of spinning. Functions
+ * marked as safe for interrupt handlers never block, and any switch they
+ * cause happens once all pending handlers have returned. */
+
+struct Mutex {
+  struct Thread *volatile owner;
+  struct WaitQueue waiters;
+};
+
+struct Semaphore {
+  volatile usize count;
+  struct WaitQueue waiters;
+};
+
+enum EVENT_WAIT {
+  EVENT_ANY = 0b00,
+  EVENT_ALL = 0b01,
+  EVENT_CLEAR = 0b10,
+};
+
+struct EventFlags {
+  volatile usize flags;
+  struct WaitQueue waiters;
+};
+
+struct Queue {
+  u8 *buffer;
+  usize item_size;
+  usize capacity;
+  volatile usize head;
+  volatile usize count;
+  struct WaitQueue senders;
+  struct WaitQueue receivers;
+};
+
+/* The owner of a contended mutex inherits the priority of its highest
+ * priority waiter until it releases all mutexes it holds. */
+void mutex_init(struct Mutex *const mutex);
+void mutex_lock(struct Mutex *const mutex);
+bool mutex_try_lock(struct Mutex *const mutex);
+void mutex_unlock(struct Mutex *const mutex);
+
+void semaphore_init(struct Semaphore *const semaphore, const usize count);
+void semaphore_wait(struct Semaphore *const semaphore);
+bool semaphore_try_wait(struct Semaphore *const semaphore); // handler safe
+void semaphore_post(struct Semaphore *const semaphore);     // handler safe
+
+void event_init(struct EventFlags *const event);
+usize event_wait(struct EventFlags *const event, const usize mask,
+                 const enum EVENT_WAIT mode);
+void event_set(struct EventFlags *const event, const usize mask); // handler safe
+void event_clear(struct EventFlags *const event, const usize mask);
+usize event_get(const struct EventFlags *const event);
+
+void queue_init(struct Queue *const queue, void *const buffer,
+                const usize item_size, const usize capacity);
+void queue_send(struct Queue *const queue, const void *const item);
+bool queue_try_send(struct Queue *const queue,
+                    const void *const item); // handler safe
+void queue_receive(struct Queue *const queue, void *const item);
+bool queue_try_receive(struct Queue *const queue,
+                       void *const item); // handler safe
+usize queue_count(const struct Queue *const queue);
@@ -2,6 +2,10 @@
 
 #include <hal/types.h>
 
+#ifndef SLEEP_TIMER
+#define SLEEP_TIMER TIMER3 // hardware timer reserved for sleep
+#endif
+
 enum TIMER {
   TIMER0 = 0b00,
   TIMER1 = 0b01,
@@ -13,8 +17,17 @@ u64 millis(void);
 u64 micros(void);
 u64 nanos(void);
 
+/* Lower halves of the runtime counters, for intervals short enough to fit in
+ * 32 bits (nanos32 wraps every 4.29 s). Differences are wrap-safe. */
+u32 millis32(void);
+u32 micros32(void);
+u32 nanos32(void);
+
 void timer_set_enabled(const enum TIMER timer, const bool enabled);
 bool timer_get_enabled(const enum TIMER timer);
 void timer_set_interval(const enum TIMER timer, const u64 interval_us);
 
+/* Sleeping threads block and a bare-metal caller parks the core in waitirq
+ * until the earliest deadline, programmed as a one-shot on SLEEP_TIMER. */
 void sleep(const u64 interval_ms);
+void sleep_us(const u64 interval_us);
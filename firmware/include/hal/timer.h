@@ -0,0 +1,41 @@
+#pragma once
+
+#include <hal/time.h>
+#include <hal/types.h>
+
+#ifndef WHEEL_TIMER
+#define WHEEL_TIMER TIMER2 // hardware timer reserved for the timer wheel
+#endif
+
+#ifndef WHEEL_TICK
+#define WHEEL_TICK 1000 // wheel resolution in microseconds
+#endif
+
+#define WHEEL_LEVELS 4
+#define WHEEL_SLOT_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_SLOT_BITS)
+
+struct SoftTimer;
+
+typedef void (*soft_timer_fn)(struct SoftTimer *const, void *const);
+
+/* Timers are owned by the caller and linked into the wheel in place, so
+ * starting and cancelling them is O(1) and allocates nothing. Callbacks run
+ * from the wheel interrupt handler. */
+struct SoftTimer {
+  struct SoftTimer *next;
+  struct SoftTimer **link;
+  u32 expires;
+  u32 period;
+  soft_timer_fn callback;
+  void *argument;
+};
+
+void timer_init(struct SoftTimer *const timer);
+void timer_start_oneshot(struct SoftTimer *const timer, const u32 delay_ms,
+                         const soft_timer_fn callback, void *const argument);
+void timer_start_periodic(struct SoftTimer *const timer, const u32 period_ms,
+                          const soft_timer_fn callback, void *const argument);
+bool timer_cancel(struct SoftTimer *const timer);
+bool timer_get_active(const struct SoftTimer *const timer);
+usize timer_get_count(void);
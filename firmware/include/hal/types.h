@@ -23,3 +23,9 @@
 #define bool usize
 #define true 1
 #define false 0
+
+/* Code and read-only data placement, the rest of .text and .rodata is in
+ * BRAM with firmware.lds and in SDRAM with firmware_sdram.lds */
+#define __fast __attribute__((section(".fast")))
+#define __sdram_text __attribute__((section(".sdram.text")))
+#define __sdram_rodata __attribute__((section(".sdram.rodata")))
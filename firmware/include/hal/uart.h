@@ -2,6 +2,10 @@
 
 #include <hal/types.h>
 
+#ifndef UART_BUFFER_SIZE
+#define UART_BUFFER_SIZE 64 // must be a power of two
+#endif
+
 enum UART_PORT {
   UART0,
   UART1,
@@ -14,3 +18,13 @@ void put_buff(const enum UART_PORT port, const char *const buffer,
               const usize length);
 void get_buff(const enum UART_PORT port, char *const buffer,
               const usize length);
+
+void uart_set_async(const enum UART_PORT port, const bool enabled);
+bool uart_get_async(const enum UART_PORT port);
+usize uart_tx_pending(const enum UART_PORT port);
+bool uart_get_overrun(const enum UART_PORT port);
+
+usize put_buff_async(const enum UART_PORT port, const char *const buffer,
+                     const usize length);
+usize get_buff_async(const enum UART_PORT port, char *const buffer,
+                     const usize length);
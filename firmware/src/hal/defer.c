@@ -0,0 +1,77 @@
+#include <hal/defer.h>
+#include <hal/irq.h>
+#include <hal/sched.h>
+
+struct DeferItem {
+  defer_fn function;
+  const void *argument;
+};
+
+static struct DeferItem defer_items[DEFER_QUEUE_SIZE];
+static volatile usize defer_head;
+static volatile usize defer_tail;
+static volatile usize defer_dropped;
+static bool defer_running;
+static struct WaitQueue defer_waiter;
+
+bool defer_post(const defer_fn function, const void *const argument) {
+  const usize state = irq_lock();
+  // Indices run freely and wrap, so their difference is the count
+  const usize tail = defer_tail;
+  const bool posted = tail - defer_head < DEFER_QUEUE_SIZE;
+  if (posted) {
+    defer_items[tail % DEFER_QUEUE_SIZE] =
+        (struct DeferItem){.function = function, .argument = argument};
+    defer_tail = tail + 1;
+    sched_wake(&defer_waiter);
+  } else {
+    ++defer_dropped;
+  }
+  irq_unlock(state);
+  sched_reschedule();
+  return posted;
+}
+
+usize defer_run(void) {
+  if (defer_head == defer_tail || irq_get_active()) {
+    return 0;
+  }
+  usize state = sched_lock();
+  if (defer_running) {
+    sched_unlock(state);
+    return 0;
+  }
+  defer_running = true;
+  sched_unlock(state);
+
+  // Producers never touch the head, so items are taken without a lock
+  usize count = 0;
+  usize head = defer_head;
+  while (head != defer_tail) {
+    const struct DeferItem item = defer_items[head % DEFER_QUEUE_SIZE];
+    defer_head = ++head;
+    item.function(item.argument);
+    ++count;
+  }
+  defer_running = false;
+  return count;
+}
+
+static void defer_worker(const void *const argument) {
+  for (;;) {
+    usize state = sched_lock();
+    while (defer_head == defer_tail) {
+      state = sched_block(&defer_waiter, state);
+    }
+    sched_unlock(state);
+    defer_run();
+  }
+}
+
+isize defer_start_thread(const usize priority) {
+  return thread_create(defer_worker, NULLPTR, priority, DEFER_STACK_SIZE);
+}
+
+usize defer_get_pending(void) { return defer_tail - defer_head; }
+
+usize defer_get_dropped(void) { return defer_dropped; }
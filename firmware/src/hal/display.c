@@ -0,0 +1,203 @@
+#include <hal/display.h>
+
+#define DISP_COLUMNS_ALL 0x0101010101010101ull
+
+extern volatile u32 __disp_planes[6];
+extern volatile u32 __disp_swap;
+extern volatile u32 __disp_mode;
+extern volatile u32 __disp_pwm[DISP_ROWS * 3];
+
+static inline u64 disp_plane_fill(const u64 plane, const u64 mask,
+                                  const bool set) {
+  return set ? plane | mask : plane & ~mask;
+}
+
+static void disp_fill_mask(struct Framebuffer *const fb, const u64 mask,
+                           const enum DISP_COLOR color) {
+  fb->red = disp_plane_fill(fb->red, mask, color & DISP_RED);
+  fb->green = disp_plane_fill(fb->green, mask, color & DISP_GREEN);
+  fb->blue = disp_plane_fill(fb->blue, mask, color & DISP_BLUE);
+}
+
+// Moves a plane by whole columns and rows, dropping bits which leave it
+static u64 disp_plane_shift(u64 plane, const isize dx, const isize dy) {
+  if (dx >= DISP_COLS || -dx >= DISP_COLS || dy >= DISP_ROWS ||
+      -dy >= DISP_ROWS) {
+    return 0;
+  }
+  if (dx > 0) {
+    plane = (plane << dx) & (DISP_COLUMNS_ALL * (0xFF << dx & 0xFF));
+  } else if (dx < 0) {
+    plane = (plane >> -dx) & (DISP_COLUMNS_ALL * (0xFF >> -dx));
+  }
+  if (dy > 0) {
+    plane <<= 8 * dy;
+  } else if (dy < 0) {
+    plane >>= 8 * -dy;
+  }
+  return plane;
+}
+
+void disp_clear(struct Framebuffer *const fb, const enum DISP_COLOR color) {
+  fb->red = color & DISP_RED ? ~0ull : 0;
+  fb->green = color & DISP_GREEN ? ~0ull : 0;
+  fb->blue = color & DISP_BLUE ? ~0ull : 0;
+}
+
+void disp_set_pixel(struct Framebuffer *const fb, const usize x, const usize y,
+                    const enum DISP_COLOR color) {
+  if (x < DISP_COLS && y < DISP_ROWS) {
+    disp_fill_mask(fb, 1ull << (y * 8 + x), color);
+  }
+}
+
+enum DISP_COLOR disp_get_pixel(const struct Framebuffer *const fb,
+                               const usize x, const usize y) {
+  if (x >= DISP_COLS || y >= DISP_ROWS) {
+    return DISP_BLACK;
+  }
+  const usize bit = y * 8 + x;
+  return (fb->red >> bit & 1) | (fb->green >> bit & 1) << 1 |
+         (fb->blue >> bit & 1) << 2;
+}
+
+void disp_fill_rect(struct Framebuffer *const fb, const usize x, const usize y,
+                    const usize width, const usize height,
+                    const enum DISP_COLOR color) {
+  if (x >= DISP_COLS || y >= DISP_ROWS) {
+    return;
+  }
+  const usize columns = width < DISP_COLS - x ? width : DISP_COLS - x;
+  const usize rows = height < DISP_ROWS - y ? height : DISP_ROWS - y;
+  const u64 row_mask = (0xFFull >> (8 - columns)) << x;
+  const u64 rows_mask = rows == DISP_ROWS ? ~0ull : (1ull << 8 * rows) - 1;
+  disp_fill_mask(fb, row_mask * DISP_COLUMNS_ALL & rows_mask << 8 * y, color);
+}
+
+void disp_fill_row(struct Framebuffer *const fb, const usize y,
+                   const enum DISP_COLOR color) {
+  disp_fill_rect(fb, 0, y, DISP_COLS, 1, color);
+}
+
+void disp_fill_col(struct Framebuffer *const fb, const usize x,
+                   const enum DISP_COLOR color) {
+  disp_fill_rect(fb, x, 0, 1, DISP_ROWS, color);
+}
+
+void disp_blit(struct Framebuffer *const fb, const struct Framebuffer *const src,
+               const isize dx, const isize dy) {
+  const u64 red = disp_plane_shift(src->red, dx, dy);
+  const u64 green = disp_plane_shift(src->green, dx, dy);
+  const u64 blue = disp_plane_shift(src->blue, dx, dy);
+  const u64 mask = red | green | blue;
+  fb->red = (fb->red & ~mask) | red;
+  fb->green = (fb->green & ~mask) | green;
+  fb->blue = (fb->blue & ~mask) | blue;
+}
+
+void disp_flush(const struct Framebuffer *const fb) {
+  while (__disp_swap & 1)
+    ;
+  __disp_planes[0] = fb->red;
+  __disp_planes[1] = fb->red >> 32;
+  __disp_planes[2] = fb->green;
+  __disp_planes[3] = fb->green >> 32;
+  __disp_planes[4] = fb->blue;
+  __disp_planes[5] = fb->blue >> 32;
+  __disp_swap = 1;
+}
+
+bool disp_get_swap_pending(void) { return __disp_swap & 1; }
+
+void disp_set_pwm(const bool enable) { __disp_mode = enable; }
+
+bool disp_get_pwm(void) { return __disp_mode & 1; }
+
+// Pixels 2 and 5 of every row straddle two words
+static void disp_pwm_store(u32 *const row, const usize x, const u16 rgb) {
+  const usize bit = x * 12;
+  const usize word = bit / 32;
+  const usize shift = bit % 32;
+  row[word] = (row[word] & ~(0xFFFu << shift)) | (u32)rgb << shift;
+  if (shift > 20) {
+    row[word + 1] = (row[word + 1] & ~(0xFFFu >> (32 - shift))) |
+                    (u32)rgb >> (32 - shift);
+  }
+}
+
+static u16 disp_pwm_load(const u32 *const row, const usize x) {
+  const usize bit = x * 12;
+  const usize word = bit / 32;
+  const usize shift = bit % 32;
+  u32 rgb = row[word] >> shift;
+  if (shift > 20) {
+    rgb |= row[word + 1] << (32 - shift);
+  }
+  return rgb & 0xFFF;
+}
+
+// Bits of a row word which belong to the pixels from x to x + columns
+static u32 disp_pwm_mask(const usize x, const usize columns, const usize word) {
+  const isize first = (isize)(x * 12) - (isize)(word * 32);
+  const isize last = (isize)((x + columns) * 12) - (isize)(word * 32);
+  const isize low = first < 0 ? 0 : first;
+  const isize high = last > 32 ? 32 : last;
+  if (high <= low) {
+    return 0;
+  }
+  const u32 below_high = high == 32 ? ~0u : (1u << high) - 1;
+  return below_high & ~((1u << low) - 1);
+}
+
+void disp_pwm_clear(struct PwmFramebuffer *const fb, const u16 rgb) {
+  disp_pwm_fill_rect(fb, 0, 0, DISP_COLS, DISP_ROWS, rgb);
+}
+
+void disp_pwm_set_pixel(struct PwmFramebuffer *const fb, const usize x,
+                        const usize y, const u16 rgb) {
+  if (x < DISP_COLS && y < DISP_ROWS) {
+    disp_pwm_store(&fb->words[y * 3], x, rgb & 0xFFF);
+  }
+}
+
+u16 disp_pwm_get_pixel(const struct PwmFramebuffer *const fb, const usize x,
+                       const usize y) {
+  if (x >= DISP_COLS || y >= DISP_ROWS) {
+    return 0;
+  }
+  return disp_pwm_load(&fb->words[y * 3], x);
+}
+
+void disp_pwm_fill_rect(struct PwmFramebuffer *const fb, const usize x,
+                        const usize y, const usize width, const usize height,
+                        const u16 rgb) {
+  if (x >= DISP_COLS || y >= DISP_ROWS) {
+    return;
+  }
+  const usize columns = width < DISP_COLS - x ? width : DISP_COLS - x;
+  const usize rows = height < DISP_ROWS - y ? height : DISP_ROWS - y;
+  if (columns == 0 || rows == 0) {
+    return;
+  }
+  // The first row is drawn by pixels and copied into the others by words
+  u32 *const first = &fb->words[y * 3];
+  for (usize column = x; column < x + columns; ++column) {
+    disp_pwm_store(first, column, rgb & 0xFFF);
+  }
+  for (usize row = 1; row < rows; ++row) {
+    u32 *const words = first + row * 3;
+    for (usize word = 0; word < 3; ++word) {
+      const u32 mask = disp_pwm_mask(x, columns, word);
+      words[word] = (words[word] & ~mask) | (first[word] & mask);
+    }
+  }
+}
+
+void disp_pwm_flush(const struct PwmFramebuffer *const fb) {
+  while (__disp_swap & 1)
+    ;
+  for (usize i = 0; i < DISP_ROWS * 3; ++i) {
+    __disp_pwm[i] = fb->words[i];
+  }
+  __disp_swap = 1;
+}
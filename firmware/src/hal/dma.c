@@ -0,0 +1,109 @@
+#include <string.h>
+
+#include <hal/dma.h>
+#include <hal/irq.h>
+#include <hal/sched.h>
+
+#define DMA_CTRL_START 0b001
+#define DMA_CTRL_BUSY 0b001
+#define DMA_MODE_COPY 0b000
+#define DMA_MODE_UART0 0b010
+#define DMA_MODE_UART1 0b100
+
+// Shorter copies are not worth programming the controller for
+#define DMA_MEMCPY_MIN 16
+
+extern volatile u32 __dma_src;
+extern volatile u32 __dma_dst;
+extern volatile u32 __dma_len;
+extern volatile u32 __dma_ctrl;
+
+static struct WaitQueue dma_waiter;
+static volatile bool dma_busy;
+static bool dma_initialized;
+
+static __fast void dma_isr(const usize irqs,
+                           union StackFrame *const stack_frame) {
+  const usize state = irq_lock();
+  dma_busy = false;
+  sched_wake(&dma_waiter);
+  irq_unlock(state);
+  sched_reschedule();
+}
+
+static void dma_start(const usize destination, const usize source,
+                      const usize length, const u32 mode) {
+  dma_wait();
+  if (!dma_initialized) {
+    irq_set_handler(IRQ_DMA, dma_isr);
+    irq_set_enabled(irq_get_enabled() | IRQ_DMA);
+    dma_initialized = true;
+  }
+  dma_busy = true;
+  __dma_src = source;
+  __dma_dst = destination;
+  __dma_len = length;
+  __dma_ctrl = mode | DMA_CTRL_START;
+}
+
+bool dma_get_busy(void) { return __dma_ctrl & DMA_CTRL_BUSY; }
+
+void dma_wait(void) {
+  if (irq_get_active()) {
+    // Completion can not be signalled from inside a handler
+    while (__dma_ctrl & DMA_CTRL_BUSY)
+      ;
+    return;
+  }
+  usize state = sched_lock();
+  while (dma_busy) {
+    if (sched_get_started()) {
+      state = sched_block(&dma_waiter, state);
+    } else {
+      irq_wait(IRQ_ALL);
+      sched_unlock(state);
+      sched_lock();
+    }
+  }
+  sched_unlock(state);
+}
+
+void dma_memcpy_async(void *const destination, const void *const source,
+                      const usize length) {
+  u8 *dst = destination;
+  const u8 *src = source;
+  usize remaining = length;
+  if (remaining < DMA_MEMCPY_MIN || (((usize)dst ^ (usize)src) & 3)) {
+    memcpy(dst, src, remaining);
+    return;
+  }
+  const usize head = -(usize)dst & 3;
+  memcpy(dst, src, head);
+  dst += head;
+  src += head;
+  remaining -= head;
+  const usize bulk = remaining & ~3;
+  dma_start((usize)dst, (usize)src, bulk, DMA_MODE_COPY);
+  memcpy(dst + bulk, src + bulk, remaining - bulk);
+}
+
+void dma_memcpy(void *const destination, const void *const source,
+                const usize length) {
+  dma_memcpy_async(destination, source, length);
+  dma_wait();
+}
+
+void dma_uart_write_async(const enum UART_PORT port, const char *const buffer,
+                          const usize length) {
+  if (length == 0) {
+    return;
+  }
+  dma_start(0, (usize)buffer, length,
+            port == UART0 ? DMA_MODE_UART0 : DMA_MODE_UART1);
+}
+
+void dma_uart_write(const enum UART_PORT port, const char *const buffer,
+                    const usize length) {
+  dma_uart_write_async(port, buffer, length);
+  dma_wait();
+}
@@ -0,0 +1,29 @@
+#include <hal/input.h>
+
+#define INPUT_EVENT_VALID (1u << 31)
+#define INPUT_EVENT_OVERRUN (1u << 30)
+#define INPUT_EVENT_HIGH (1u << 8)
+#define INPUT_EVENT_INPUT 0xF
+
+extern volatile u32 __input_event;
+extern volatile u32 __input_time;
+extern volatile u32 __input_debounce;
+
+bool input_poll_event(struct InputEvent *const event) {
+  const u32 value = __input_event;
+  if (!(value & INPUT_EVENT_VALID)) {
+    return false;
+  }
+  // The time of the popped event is kept until the next one is read
+  event->input = value & INPUT_EVENT_INPUT;
+  event->state = value & INPUT_EVENT_HIGH ? HIGH : LOW;
+  event->micros = __input_time;
+  event->overrun = value & INPUT_EVENT_OVERRUN;
+  return true;
+}
+
+void input_set_debounce(const u32 interval_us) {
+  __input_debounce = interval_us > 0xFFFF ? 0xFFFF : interval_us;
+}
+
+u32 input_get_debounce(void) { return __input_debounce; }
@@ -1,22 +1,53 @@
+#include <hal/bits.h>
 #include <hal/gpio.h>
 #include <hal/irq.h>
+#include <hal/perf.h>
 #include <hal/types.h>
 
 extern usize __irq_set_mask(const usize mask);
 extern usize __irq_get_mask(void);
 extern void __irq_wait(const usize mask);
+extern usize __irq_timer(const usize cycles);
+extern void __irq_nest(const irq_fn handler, const usize irqs,
+                       union StackFrame *const stack_frame, const usize mask);
 extern void __ecall(void);
 
 static irq_fn irq_vector[IRQ_COUNT];
+static usize irq_registered;
+static usize irq_priority[IRQ_PRIORITY_COUNT];
+static usize irq_nested;
+
+static irq_switch_fn irq_switch;
+static volatile bool irq_switch_requested;
+static volatile bool irq_active;
+static volatile bool irq_preemptible;
+static volatile u32 irq_masked_max;
+
+usize __irq_full_frame;
 
 usize irq_set_enabled(const enum IRQ mask) { return ~__irq_set_mask(~mask); }
 
 usize irq_get_enabled(void) { return ~__irq_get_mask(); }
 
-void irq_wait(const enum IRQ mask) { __irq_wait(mask); }
+/* Masked IRQs stay pending and end waitirq at once, so let the ones without
+ * a handler be taken and dropped first. Internal IRQs keep trapping. */
+void irq_wait(const enum IRQ mask) {
+  const usize enabled = irq_get_enabled();
+  const usize stale =
+      ~(enabled | irq_registered | IRQ_INT_TIMER | IRQ_ECALL | IRQ_BUS_ERROR);
+  if (stale) {
+    irq_set_enabled(enabled | stale);
+    irq_set_enabled(enabled);
+  }
+  __irq_wait(mask);
+}
+
+usize irq_set_timer(const usize cycles) { return __irq_timer(cycles); }
 
+/* The ecall would trap inside any handler, including nested ones, whose
+ * level mask keeps IRQ_ECALL masked. */
 bool irq_ecall(void) {
-  if (__irq_get_mask() & IRQ_ECALL) {
+  if (irq_active || __irq_get_mask() & IRQ_ECALL) {
     return false;
   } else {
     __ecall();
@@ -25,27 +56,148 @@ bool irq_ecall(void) {
 }
 
 void irq_set_handler(const enum IRQ irq, const irq_fn handler) {
-  usize bitmap = irq;
-  usize index = 0;
-  while (!(bitmap & 1)) {
-    bitmap >>= 1;
-    ++index;
+  irq_set_handler_frame(irq, handler, IRQ_FRAME_CALLER_SAVED);
+}
+
+void irq_set_handler_frame(const enum IRQ irq, const irq_fn handler,
+                           const enum IRQ_FRAME frame) {
+  const usize index = bits_ctz(irq);
+  if (handler == IRQ_UNSET) {
+    irq_registered &= ~irq;
+  } else {
+    irq_registered |= irq;
+  }
+  if (frame == IRQ_FRAME_FULL) {
+    __irq_full_frame |= irq;
+  } else {
+    __irq_full_frame &= ~irq;
   }
   irq_vector[index] = handler;
 }
 
+void irq_set_priority(const enum IRQ mask, const enum IRQ_PRIORITY priority) {
+  for (usize level = 0; level < IRQ_PRIORITY_COUNT; ++level) {
+    irq_priority[level] &= ~mask;
+  }
+  irq_priority[priority] |= mask;
+}
+
+void irq_set_nested(const enum IRQ mask, const bool nested) {
+  irq_nested = nested ? irq_nested | mask : irq_nested & ~mask;
+}
+
+bool irq_get_nested(const enum IRQ irq) { return irq_nested & irq; }
+
+usize irq_lock(void) {
+  return irq_active && !irq_preemptible ? IRQ_NONE : irq_set_enabled(IRQ_NONE);
+}
+
+void irq_unlock(const usize state) {
+  if (!irq_active || irq_preemptible) {
+    irq_set_enabled(state);
+  }
+}
+
+enum IRQ_PRIORITY irq_get_priority(const enum IRQ irq) {
+  for (usize level = 0; level < IRQ_PRIORITY_COUNT; ++level) {
+    if (irq_priority[level] & irq) {
+      return level;
+    }
+  }
+  return IRQ_PRIORITY_NORMAL;
+}
+
+void irq_set_switch_handler(const irq_switch_fn handler) {
+  irq_switch = handler;
+}
+
+void irq_request_switch(void) {
+  if (irq_switch != NULLPTR) {
+    irq_switch_requested = true;
+  }
+}
+
+bool irq_get_active(void) { return irq_active; }
+
+u32 irq_get_masked_max(void) { return irq_masked_max; }
+
+void irq_reset_masked_max(void) { irq_masked_max = 0; }
+
 void __irq_init(void) {
+  __irq_full_frame = 0;
+  irq_switch = NULLPTR;
+  irq_switch_requested = false;
+  irq_active = false;
+  irq_preemptible = false;
+  irq_masked_max = 0;
+  irq_registered = 0;
+  irq_nested = 0;
+  for (usize level = 0; level < IRQ_PRIORITY_COUNT; ++level) {
+    irq_priority[level] = 0;
+  }
+  irq_priority[IRQ_PRIORITY_NORMAL] = IRQ_ALL;
   for (usize i = 0; i < IRQ_COUNT; ++i) {
     irq_vector[i] = IRQ_UNSET;
   }
 }
 
-void __isr(const usize irqs, union StackFrame *const stack_frame) {
-  volatile usize j = 0;
-  for (usize i = 0; i < IRQ_COUNT; ++i) {
-    if (((1 << i) & irqs) && (irq_vector[i] != IRQ_UNSET)) {
-      ++j;
-      irq_vector[i](irqs, stack_frame);
+/* IRQs which may preempt a nested handler of the given priority. Handlers
+ * with a full frame save it over the interrupted thread, so they never
+ * preempt, and neither do the internal traps. */
+static __fast usize irq_nest_mask(const usize level) {
+  usize preempting = 0;
+  for (usize higher = level + 1; higher < IRQ_PRIORITY_COUNT; ++higher) {
+    preempting |= irq_priority[higher];
+  }
+  return ~(preempting & irq_registered & ~__irq_full_frame &
+           ~(IRQ_ECALL | IRQ_BUS_ERROR));
+}
+
+/* Returns true if a switch was requested without a full frame, in which
+ * case the entry code saves one and calls back with no pending IRQs. A
+ * preempting call leaves the switch to the handler it preempted. */
+__fast bool __isr(const usize irqs,
+                  union StackFrame *const stack_frame) {
+  const u32 start = IRQ_MASKED_STATS ? perf_cycles32() : 0;
+  u32 unmasked = 0;
+  const usize pending = irqs & irq_registered;
+  const bool preempting = irq_active;
+  const bool preemptible = irq_preemptible;
+  irq_active = true;
+  irq_preemptible = false;
+  for (isize level = IRQ_PRIORITY_COUNT - 1; pending && level >= 0; --level) {
+    usize bitmap = pending & irq_priority[level];
+    while (bitmap) {
+      const usize index = bits_ctz(bitmap);
+      bitmap &= bitmap - 1;
+      if (irq_nested & 1 << index) {
+        const u32 nest_start = IRQ_MASKED_STATS ? perf_cycles32() : 0;
+        irq_preemptible = true;
+        __irq_nest(irq_vector[index], irqs, stack_frame, irq_nest_mask(level));
+        irq_preemptible = false;
+        if (IRQ_MASKED_STATS) {
+          unmasked += perf_cycles32() - nest_start;
+        }
+      } else {
+        irq_vector[index](irqs, stack_frame);
+      }
     }
   }
+  irq_active = preempting;
+  irq_preemptible = preemptible;
+  if (IRQ_MASKED_STATS) {
+    const u32 cycles = perf_cycles32() - start - unmasked;
+    if (cycles > irq_masked_max) {
+      irq_masked_max = cycles;
+    }
+  }
+  if (!irq_switch_requested || preempting) {
+    return false;
+  }
+  if (stack_frame == NULLPTR) {
+    return true;
+  }
+  irq_switch_requested = false;
+  irq_switch(stack_frame);
+  return false;
 }
@@ -4,8 +4,6 @@
 #include <hal/types.h>
 #include <hal/uart.h>
 
-extern const usize __stack_end;
-
 enum UART_PORT __fd_to_uart(const int file) {
   switch (file) {
   case 0:
@@ -20,16 +18,6 @@ enum UART_PORT __fd_to_uart(const int file) {
   }
 }
 
-static u8 *brk;
-
-void __libc_init_brk() { brk = (u8 *)&__stack_end; }
-
-void *_sbrk(const int incr) {
-  const u8 *last = brk;
-  brk += incr;
-  return (void *)last;
-}
-
 int _close(const int file) { return -1; }
 
 int _fstat(const int file, struct stat *const st) {
@@ -52,9 +40,7 @@ int _write(const int file, const char *const ptr, const int len) {
   if (port == -1) {
     return -1;
   }
-  for (int i = 0; i < len; ++i) {
-    put_ch(port, ptr[i]);
-  }
+  put_buff(port, ptr, len);
   return len;
 }
 
@@ -63,8 +49,6 @@ int _read(const int file, char *const ptr, const int len) {
   if (port == -1) {
     return -1;
   }
-  for (int i = 0; i < len; ++i) {
-    ptr[i] = get_ch(port);
-  }
+  get_buff(port, ptr, len);
   return len;
 }
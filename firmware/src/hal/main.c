@@ -1,9 +1,12 @@
+#include <hal/defer.h>
+
 extern void setup(void), loop(void);
 
 int main(void) {
   setup();
   for (;;) {
     loop();
+    defer_run();
   }
   return 0;
 }
@@ -0,0 +1,101 @@
+#include <errno.h>
+
+#include <hal/mem.h>
+#include <hal/sched.h>
+
+extern u8 __stack_end;
+extern u8 __stack_start;
+extern u8 __sdram_start;
+extern u8 __sdram_end;
+
+static u8 *heap_start;
+static u8 *heap_end;
+static u8 *brk;
+
+void __libc_init_brk() {
+  if (MEM_HEAP_SDRAM) {
+    heap_start = &__sdram_start;
+    heap_end = &__sdram_end;
+  } else {
+    heap_start = &__stack_end;
+    heap_end = &__stack_start - MEM_STACK_RESERVE;
+  }
+  brk = heap_start;
+}
+
+void *_sbrk(const int incr) {
+  u8 *const last = brk;
+  if (incr > heap_end - brk || incr < heap_start - brk) {
+    errno = ENOMEM;
+    return (void *)-1;
+  }
+  brk += incr;
+  return last;
+}
+
+usize mem_heap_used(void) { return brk - heap_start; }
+
+usize mem_heap_free(void) { return heap_end - brk; }
+
+void mem_pool_init(struct MemPool *const pool, void *const buffer,
+                   const usize block_size, const usize count) {
+  pool->free = NULLPTR;
+  pool->block_size = MEM_POOL_BLOCK(block_size);
+  pool->next = buffer;
+  pool->end = pool->next + pool->block_size * count;
+  pool->used = 0;
+}
+
+__fast void *mem_pool_alloc(struct MemPool *const pool) {
+  const usize state = sched_lock();
+  void *block = pool->free;
+  if (block != NULLPTR) {
+    pool->free = *(void **)block;
+  } else if (pool->next != pool->end) {
+    block = pool->next;
+    pool->next += pool->block_size;
+  }
+  if (block != NULLPTR) {
+    ++pool->used;
+  }
+  sched_unlock(state);
+  return block;
+}
+
+__fast void mem_pool_free(struct MemPool *const pool, void *const block) {
+  if (block == NULLPTR) {
+    return;
+  }
+  const usize state = sched_lock();
+  *(void **)block = pool->free;
+  pool->free = block;
+  --pool->used;
+  sched_unlock(state);
+}
+
+usize mem_pool_used(const struct MemPool *const pool) { return pool->used; }
+
+void mem_arena_init(struct MemArena *const arena, void *const buffer,
+                    const usize size) {
+  arena->start = buffer;
+  arena->next = arena->start;
+  arena->end = arena->start + size;
+}
+
+void *mem_arena_alloc(struct MemArena *const arena, const usize size) {
+  u8 *const block =
+      (u8 *)(((ptr)arena->next + MEM_ALIGN - 1) & ~(ptr)(MEM_ALIGN - 1));
+  if (block > arena->end || size > (usize)(arena->end - block)) {
+    return NULLPTR;
+  }
+  arena->next = block + size;
+  return block;
+}
+
+void mem_arena_reset(struct MemArena *const arena) {
+  arena->next = arena->start;
+}
+
+usize mem_arena_used(const struct MemArena *const arena) {
+  return arena->next - arena->start;
+}
@@ -0,0 +1,123 @@
+#include <string.h>
+
+#include <hal/irq.h>
+#include <hal/perf.h>
+#include <hal/time.h>
+#include <hal/uart.h>
+
+#define PERF_BUCKET_SHIFT 2
+#define PERF_UART UART1
+
+static u32 *volatile perf_histogram;
+static usize perf_buckets;
+static volatile u32 perf_samples;
+static volatile u32 perf_outside;
+
+static __fast void perf_sample(const usize irqs,
+                               union StackFrame *const frame) {
+  const usize bucket = frame->abi.pc >> PERF_BUCKET_SHIFT;
+  if (bucket < perf_buckets) {
+    ++perf_histogram[bucket];
+  } else {
+    ++perf_outside;
+  }
+  ++perf_samples;
+  irq_set_timer(PERF_SAMPLE_PERIOD);
+}
+
+/* Formatting is done by hand, so that linking the HAL does not pull printf
+ * into every firmware image. */
+static void perf_put_str(const char *const string) {
+  put_buff(PERF_UART, string, strlen(string));
+}
+
+static void perf_put_num(u32 value, const usize base, const usize width,
+                         const char padding) {
+  char digits[10];
+  usize length = 0;
+  do {
+    digits[length++] = "0123456789abcdef"[value % base];
+    value /= base;
+  } while (value);
+  for (usize i = length; i < width; ++i) {
+    put_ch(PERF_UART, padding);
+  }
+  while (length > 0) {
+    put_ch(PERF_UART, digits[--length]);
+  }
+}
+
+void perf_print(const struct PerfCounter *const counter) {
+  const u32 calls = counter->calls ? counter->calls : 1;
+  perf_put_str(counter->name);
+  perf_put_str(": ");
+  perf_put_num(counter->calls, 10, 0, ' ');
+  perf_put_str(" calls, ");
+  perf_put_num(counter->cycles / calls, 10, 0, ' ');
+  perf_put_str(" cycles/call, ");
+  perf_put_num(counter->instret / calls, 10, 0, ' ');
+  perf_put_str(" instr/call, ");
+  perf_put_num(counter->cycles_max, 10, 0, ' ');
+  perf_put_str(" cycles max\n");
+}
+
+void perf_reset(struct PerfCounter *const counter) {
+  counter->calls = 0;
+  counter->cycles = 0;
+  counter->instret = 0;
+  counter->cycles_max = 0;
+}
+
+u32 perf_idle_count(const u32 window_ms) {
+  u32 iterations = 0;
+  const u32 start = millis32();
+  while (millis32() - start < window_ms) {
+    ++iterations;
+  }
+  return iterations;
+}
+
+u64 perf_idle_lost_ns(const u32 baseline, const u32 iterations,
+                      const u32 window_ms) {
+  if (baseline == 0 || iterations >= baseline) {
+    return 0;
+  }
+  return (u64)(baseline - iterations) * window_ms * 1000000 / baseline;
+}
+
+void perf_profile_start(u32 *const histogram, const usize buckets) {
+  for (usize i = 0; i < buckets; ++i) {
+    histogram[i] = 0;
+  }
+  perf_histogram = histogram;
+  perf_buckets = buckets;
+  perf_samples = 0;
+  perf_outside = 0;
+  irq_set_handler_frame(IRQ_INT_TIMER, perf_sample, IRQ_FRAME_FULL);
+  irq_set_enabled(irq_get_enabled() | IRQ_INT_TIMER);
+  irq_set_timer(PERF_SAMPLE_PERIOD);
+}
+
+void perf_profile_stop(void) {
+  irq_set_timer(0);
+  irq_set_enabled(irq_get_enabled() & ~IRQ_INT_TIMER);
+}
+
+/* Read by common/scripts/profile.py together with the unstripped ELF. */
+void perf_profile_dump(void) {
+  perf_put_str("PROFILE BEGIN ");
+  perf_put_num(perf_samples, 10, 0, ' ');
+  perf_put_str(" ");
+  perf_put_num(perf_outside, 10, 0, ' ');
+  perf_put_str("\n");
+  for (usize i = 0; i < perf_buckets; ++i) {
+    if (perf_histogram[i]) {
+      perf_put_str("PROFILE ");
+      perf_put_num(i << PERF_BUCKET_SHIFT, 16, 8, '0');
+      perf_put_str(" ");
+      perf_put_num(perf_histogram[i], 10, 0, ' ');
+      perf_put_str("\n");
+    }
+  }
+  perf_put_str("PROFILE END\n");
+}
@@ -0,0 +1,317 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <hal/bits.h>
+#include <hal/irq.h>
+#include <hal/sched.h>
+#include <hal/time.h>
+
+#define SCHED_IDLE_STACK_SIZE 512
+#define SCHED_STACK_ALIGN 16
+
+extern union StackFrame *volatile __irq_frame;
+extern u8 __global_pointer;
+
+static struct Thread *sched_threads[SCHED_MAX_THREADS];
+static struct Thread *sched_ready[SCHED_PRIORITY_COUNT];
+static volatile usize sched_ready_bitmap;
+static struct Thread *volatile sched_current;
+
+static void ready_insert(struct Thread *const thread) {
+  struct Thread *const head = sched_ready[thread->priority];
+  if (head == NULLPTR) {
+    thread->next = thread->prev = thread;
+    sched_ready[thread->priority] = thread;
+    sched_ready_bitmap |= 1 << thread->priority;
+  } else {
+    thread->next = head;
+    thread->prev = head->prev;
+    head->prev->next = thread;
+    head->prev = thread;
+  }
+}
+
+static void ready_remove(struct Thread *const thread) {
+  if (thread->next == thread) {
+    sched_ready[thread->priority] = NULLPTR;
+    sched_ready_bitmap &= ~(1 << thread->priority);
+  } else {
+    thread->prev->next = thread->next;
+    thread->next->prev = thread->prev;
+    if (sched_ready[thread->priority] == thread) {
+      sched_ready[thread->priority] = thread->next;
+    }
+  }
+}
+
+static void wait_insert(struct WaitQueue *const queue,
+                        struct Thread *const thread) {
+  struct Thread **link = &queue->head;
+  while (*link != NULLPTR && (*link)->priority <= thread->priority) {
+    link = &(*link)->next;
+  }
+  thread->next = *link;
+  thread->wait_queue = queue;
+  *link = thread;
+}
+
+static void wait_remove(struct WaitQueue *const queue,
+                        struct Thread *const thread) {
+  struct Thread **link = &queue->head;
+  while (*link != NULLPTR && *link != thread) {
+    link = &(*link)->next;
+  }
+  if (*link == thread) {
+    *link = thread->next;
+  }
+  thread->wait_queue = NULLPTR;
+}
+
+static isize thread_index(const struct Thread *const thread) {
+  for (usize t = 0; t < SCHED_MAX_THREADS; ++t) {
+    if (sched_threads[t] == thread) {
+      return t;
+    }
+  }
+  return SCHED_NO_THREAD;
+}
+
+/* Reuse the block of an exited thread if its stack is large enough,
+ * otherwise release it and allocate a new one. */
+static isize thread_alloc(const usize stack_size) {
+  isize free_slot = SCHED_NO_THREAD;
+  for (usize t = 0; t < SCHED_MAX_THREADS; ++t) {
+    struct Thread *const thread = sched_threads[t];
+    if (thread == NULLPTR) {
+      if (free_slot == SCHED_NO_THREAD) {
+        free_slot = t;
+      }
+    } else if (thread->state == THREAD_UNUSED) {
+      if (thread->stack_size >= stack_size) {
+        return t;
+      }
+      free_slot = t;
+    }
+  }
+  if (free_slot == SCHED_NO_THREAD) {
+    return SCHED_NO_THREAD;
+  }
+  free(sched_threads[free_slot]);
+  struct Thread *const thread =
+      malloc(sizeof(struct Thread) + stack_size + SCHED_STACK_ALIGN);
+  sched_threads[free_slot] = thread;
+  if (thread == NULLPTR) {
+    return SCHED_NO_THREAD;
+  }
+  thread->state = THREAD_UNUSED;
+  thread->stack_size = stack_size;
+  return free_slot;
+}
+
+static void thread_guard(const thread_fn entrypoint,
+                         const void *const argument) {
+  entrypoint(argument);
+  thread_exit();
+}
+
+static void thread_idle(const void *const argument) {
+  for (;;) {
+    irq_wait(IRQ_ALL);
+  }
+}
+
+/* Switching threads only redirects the frame pointer used by the interrupt
+ * exit code. */
+static __fast void sched_switch(union StackFrame *const frame) {
+  sched_current = sched_ready[bits_ctz(sched_ready_bitmap)];
+  __irq_frame = &sched_current->frame;
+}
+
+/* Runs with a full frame on ECALL and on every time slice, and moves the
+ * current thread behind its peers of the same priority. */
+static __fast void sched_isr(const usize irqs,
+                             union StackFrame *const frame) {
+  struct Thread *const current = sched_current;
+  const usize priority = bits_ctz(sched_ready_bitmap);
+  if (current->state == THREAD_READY && current->priority == priority &&
+      sched_ready[priority] == current) {
+    sched_ready[priority] = current->next;
+  }
+  sched_switch(frame);
+}
+
+usize sched_lock(void) { return irq_set_enabled(IRQ_NONE); }
+
+void sched_unlock(const usize state) { irq_set_enabled(state); }
+
+bool sched_get_started(void) { return sched_current != NULLPTR; }
+
+void sched_start(const usize main_priority) {
+  if (sched_get_started()) {
+    return;
+  }
+  usize state = sched_lock();
+  thread_create(thread_idle, NULLPTR, SCHED_PRIORITY_IDLE,
+                SCHED_IDLE_STACK_SIZE);
+  const isize main_id = thread_alloc(0);
+  if (main_id == SCHED_NO_THREAD) {
+    sched_unlock(state);
+    return;
+  }
+  struct Thread *const main_thread = sched_threads[main_id];
+  main_thread->priority = main_thread->base_priority = main_priority;
+  main_thread->wait_queue = NULLPTR;
+  main_thread->blocked_on = NULLPTR;
+  main_thread->mutex_count = 0;
+  main_thread->state = THREAD_READY;
+  ready_insert(main_thread);
+  sched_current = main_thread;
+  __irq_frame = &main_thread->frame;
+  irq_set_switch_handler(sched_switch);
+  irq_set_handler_frame(IRQ_ECALL, sched_isr, IRQ_FRAME_FULL);
+  irq_set_handler_frame(IRQ_TIMER0, sched_isr, IRQ_FRAME_FULL);
+  timer_set_interval(TIMER0, SCHED_TIME_SLICE);
+  timer_set_enabled(TIMER0, true);
+  state |= IRQ_ECALL | IRQ_TIMER0;
+  sched_unlock(state);
+  sched_reschedule();
+}
+
+isize thread_create(const thread_fn entrypoint, const void *const argument,
+                    const usize priority, const usize stack_size) {
+  if (priority >= SCHED_PRIORITY_COUNT) {
+    return SCHED_NO_THREAD;
+  }
+  const usize state = sched_lock();
+  const isize id = thread_alloc(stack_size);
+  if (id == SCHED_NO_THREAD) {
+    sched_unlock(state);
+    return SCHED_NO_THREAD;
+  }
+  struct Thread *const thread = sched_threads[id];
+  memset(&thread->frame, 0, sizeof(thread->frame));
+  thread->frame.abi.pc = (ptr)thread_guard;
+  thread->frame.abi.a0 = (ptr)entrypoint;
+  thread->frame.abi.a1 = (ptr)argument;
+  thread->frame.abi.gp = (ptr)&__global_pointer;
+  thread->frame.abi.sp = ((ptr)(thread + 1) + thread->stack_size) &
+                         ~(ptr)(SCHED_STACK_ALIGN - 1);
+  thread->priority = thread->base_priority = priority;
+  thread->wait_queue = NULLPTR;
+  thread->blocked_on = NULLPTR;
+  thread->mutex_count = 0;
+  thread->state = THREAD_READY;
+  ready_insert(thread);
+  sched_unlock(state);
+  sched_reschedule();
+  return id;
+}
+
+void thread_exit(void) {
+  const usize state = sched_lock();
+  struct Thread *const current = sched_current;
+  ready_remove(current);
+  current->state = THREAD_UNUSED;
+  sched_unlock(state | IRQ_ECALL);
+  irq_ecall();
+  for (;;)
+    ;
+}
+
+void thread_yield(void) { irq_ecall(); }
+
+isize thread_self(void) { return thread_index(sched_current); }
+
+void thread_set_priority(const isize thread_id, const usize priority) {
+  if (thread_id < 0 || thread_id >= SCHED_MAX_THREADS ||
+      priority >= SCHED_PRIORITY_COUNT) {
+    return;
+  }
+  const usize state = sched_lock();
+  struct Thread *const thread = sched_threads[thread_id];
+  if (thread == NULLPTR || thread->state == THREAD_UNUSED) {
+    sched_unlock(state);
+    return;
+  }
+  thread->base_priority = priority;
+  if (thread->mutex_count == 0 || priority < thread->priority) {
+    sched_set_priority(thread, priority);
+  }
+  sched_unlock(state);
+  sched_reschedule();
+}
+
+usize thread_get_priority(const isize thread_id) {
+  if (thread_id < 0 || thread_id >= SCHED_MAX_THREADS ||
+      sched_threads[thread_id] == NULLPTR) {
+    return SCHED_PRIORITY_IDLE;
+  }
+  return sched_threads[thread_id]->priority;
+}
+
+struct Thread *sched_self(void) { return sched_current; }
+
+usize sched_block(struct WaitQueue *const queue, const usize state) {
+  struct Thread *const current = sched_current;
+  if (current == NULLPTR || irq_get_active()) {
+    sched_unlock(state);
+    sched_lock();
+    return state;
+  }
+  ready_remove(current);
+  current->state = THREAD_BLOCKED;
+  wait_insert(queue, current);
+  sched_unlock(state | IRQ_ECALL);
+  irq_ecall();
+  sched_lock();
+  return state;
+}
+
+struct Thread *sched_wake(struct WaitQueue *const queue) {
+  struct Thread *const thread = queue->head;
+  if (thread == NULLPTR) {
+    return NULLPTR;
+  }
+  wait_remove(queue, thread);
+  thread->state = THREAD_READY;
+  ready_insert(thread);
+  return thread;
+}
+
+usize sched_wake_all(struct WaitQueue *const queue) {
+  usize woken = 0;
+  while (sched_wake(queue) != NULLPTR) {
+    ++woken;
+  }
+  return woken;
+}
+
+void sched_set_priority(struct Thread *const thread, const usize priority) {
+  if (thread->priority == priority) {
+    return;
+  }
+  if (thread->state == THREAD_READY) {
+    ready_remove(thread);
+    thread->priority = priority;
+    ready_insert(thread);
+  } else if (thread->state == THREAD_BLOCKED) {
+    struct WaitQueue *const queue = thread->wait_queue;
+    wait_remove(queue, thread);
+    thread->priority = priority;
+    wait_insert(queue, thread);
+  } else {
+    thread->priority = priority;
+  }
+}
+
+void sched_reschedule(void) {
+  if (sched_current == NULLPTR ||
+      bits_ctz(sched_ready_bitmap) >= sched_current->priority) {
+    return;
+  }
+  if (irq_get_active()) {
+    irq_request_switch();
+  } else {
+    thread_yield();
+  }
+}
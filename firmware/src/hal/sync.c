@@ -0,0 +1,233 @@
+#include <string.h>
+
+#include <hal/sched.h>
+#include <hal/sync.h>
+
+/* Raise the priority of the owner, and of any owner it is blocked on in
+ * turn, so a lower priority thread cannot delay the waiter indefinitely. */
+static void mutex_inherit(struct Mutex *mutex, const usize priority) {
+  for (usize depth = 0; mutex != NULLPTR && depth < SCHED_MAX_THREADS;
+       ++depth) {
+    struct Thread *const owner = mutex->owner;
+    if (owner == NULLPTR || owner->priority <= priority) {
+      return;
+    }
+    sched_set_priority(owner, priority);
+    mutex = owner->blocked_on;
+  }
+}
+
+void mutex_init(struct Mutex *const mutex) {
+  mutex->owner = NULLPTR;
+  mutex->waiters.head = NULLPTR;
+}
+
+void mutex_lock(struct Mutex *const mutex) {
+  usize state = sched_lock();
+  struct Thread *const self = sched_self();
+  if (self == NULLPTR) {
+    sched_unlock(state);
+    return;
+  }
+  while (mutex->owner != self) {
+    if (mutex->owner == NULLPTR) {
+      mutex->owner = self;
+      ++self->mutex_count;
+      break;
+    }
+    mutex_inherit(mutex, self->priority);
+    self->blocked_on = mutex;
+    state = sched_block(&mutex->waiters, state);
+    self->blocked_on = NULLPTR;
+  }
+  sched_unlock(state);
+}
+
+bool mutex_try_lock(struct Mutex *const mutex) {
+  const usize state = sched_lock();
+  struct Thread *const self = sched_self();
+  const bool locked = self == NULLPTR || mutex->owner == NULLPTR;
+  if (self != NULLPTR && locked) {
+    mutex->owner = self;
+    ++self->mutex_count;
+  }
+  sched_unlock(state);
+  return locked;
+}
+
+/* Ownership is handed directly to the highest priority waiter, which then
+ * inherits the priority of the remaining ones. */
+void mutex_unlock(struct Mutex *const mutex) {
+  const usize state = sched_lock();
+  struct Thread *const self = sched_self();
+  if (self == NULLPTR || mutex->owner != self) {
+    sched_unlock(state);
+    return;
+  }
+  if (--self->mutex_count == 0) {
+    sched_set_priority(self, self->base_priority);
+  }
+  struct Thread *const next = sched_wake(&mutex->waiters);
+  mutex->owner = next;
+  if (next != NULLPTR) {
+    ++next->mutex_count;
+    next->blocked_on = NULLPTR;
+    struct Thread *const waiter = mutex->waiters.head;
+    if (waiter != NULLPTR && waiter->priority < next->priority) {
+      sched_set_priority(next, waiter->priority);
+    }
+  }
+  sched_unlock(state);
+  sched_reschedule();
+}
+
+void semaphore_init(struct Semaphore *const semaphore, const usize count) {
+  semaphore->count = count;
+  semaphore->waiters.head = NULLPTR;
+}
+
+void semaphore_wait(struct Semaphore *const semaphore) {
+  usize state = sched_lock();
+  while (semaphore->count == 0) {
+    state = sched_block(&semaphore->waiters, state);
+  }
+  --semaphore->count;
+  sched_unlock(state);
+}
+
+bool semaphore_try_wait(struct Semaphore *const semaphore) {
+  const usize state = sched_lock();
+  const bool acquired = semaphore->count > 0;
+  if (acquired) {
+    --semaphore->count;
+  }
+  sched_unlock(state);
+  return acquired;
+}
+
+void semaphore_post(struct Semaphore *const semaphore) {
+  const usize state = sched_lock();
+  ++semaphore->count;
+  sched_wake(&semaphore->waiters);
+  sched_unlock(state);
+  sched_reschedule();
+}
+
+static bool event_satisfied(const usize flags, const usize mask,
+                            const enum EVENT_WAIT mode) {
+  if (mode & EVENT_ALL) {
+    return (flags & mask) == mask;
+  } else {
+    return (flags & mask) != 0;
+  }
+}
+
+void event_init(struct EventFlags *const event) {
+  event->flags = 0;
+  event->waiters.head = NULLPTR;
+}
+
+usize event_wait(struct EventFlags *const event, const usize mask,
+                 const enum EVENT_WAIT mode) {
+  usize state = sched_lock();
+  while (!event_satisfied(event->flags, mask, mode)) {
+    state = sched_block(&event->waiters, state);
+  }
+  const usize flags = event->flags & mask;
+  if (mode & EVENT_CLEAR) {
+    event->flags &= ~flags;
+  }
+  sched_unlock(state);
+  return flags;
+}
+
+void event_set(struct EventFlags *const event, const usize mask) {
+  const usize state = sched_lock();
+  event->flags |= mask;
+  sched_wake_all(&event->waiters);
+  sched_unlock(state);
+  sched_reschedule();
+}
+
+void event_clear(struct EventFlags *const event, const usize mask) {
+  const usize state = sched_lock();
+  event->flags &= ~mask;
+  sched_unlock(state);
+}
+
+usize event_get(const struct EventFlags *const event) { return event->flags; }
+
+void queue_init(struct Queue *const queue, void *const buffer,
+                const usize item_size, const usize capacity) {
+  queue->buffer = buffer;
+  queue->item_size = item_size;
+  queue->capacity = capacity;
+  queue->head = 0;
+  queue->count = 0;
+  queue->senders.head = NULLPTR;
+  queue->receivers.head = NULLPTR;
+}
+
+static void queue_push(struct Queue *const queue, const void *const item) {
+  usize tail = queue->head + queue->count;
+  if (tail >= queue->capacity) {
+    tail -= queue->capacity;
+  }
+  memcpy(queue->buffer + tail * queue->item_size, item, queue->item_size);
+  ++queue->count;
+  sched_wake(&queue->receivers);
+}
+
+static void queue_pop(struct Queue *const queue, void *const item) {
+  memcpy(item, queue->buffer + queue->head * queue->item_size,
+         queue->item_size);
+  if (++queue->head == queue->capacity) {
+    queue->head = 0;
+  }
+  --queue->count;
+  sched_wake(&queue->senders);
+}
+
+void queue_send(struct Queue *const queue, const void *const item) {
+  usize state = sched_lock();
+  while (queue->count == queue->capacity) {
+    state = sched_block(&queue->senders, state);
+  }
+  queue_push(queue, item);
+  sched_unlock(state);
+  sched_reschedule();
+}
+
+bool queue_try_send(struct Queue *const queue, const void *const item) {
+  const usize state = sched_lock();
+  const bool sent = queue->count < queue->capacity;
+  if (sent) {
+    queue_push(queue, item);
+  }
+  sched_unlock(state);
+  sched_reschedule();
+  return sent;
+}
+
+void queue_receive(struct Queue *const queue, void *const item) {
+  usize state = sched_lock();
+  while (queue->count == 0) {
+    state = sched_block(&queue->receivers, state);
+  }
+  queue_pop(queue, item);
+  sched_unlock(state);
+  sched_reschedule();
+}
+
+bool queue_try_receive(struct Queue *const queue, void *const item) {
+  const usize state = sched_lock();
+  const bool received = queue->count > 0;
+  if (received) {
+    queue_pop(queue, item);
+  }
+  sched_unlock(state);
+  sched_reschedule();
+  return received;
+}
+
+usize queue_count(const struct Queue *const queue) { return queue->count; }
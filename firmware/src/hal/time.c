@@ -1,5 +1,17 @@
+#include <hal/irq.h>
+#include <hal/sched.h>
 #include <hal/time.h>
 
+#define SLEEP_IRQ (IRQ_TIMER0 << SLEEP_TIMER)
+#define SLEEP_INTERVAL_MAX 0xFFFFFFFF
+
+struct Sleeper {
+  u64 deadline;
+  struct Sleeper *next;
+  volatile bool expired;
+  struct WaitQueue waiter;
+};
+
 extern volatile u64 __counter_nanos;
 extern volatile u64 __counter_micros;
 extern volatile u64 __counter_millis;
@@ -8,11 +20,32 @@ extern volatile u8 __timer_reset;
 extern volatile u8 __timer_select;
 extern volatile u32 __timer_interval;
 
-u64 millis(void) { return __counter_millis; }
+static struct Sleeper *sleep_queue;
+static bool sleep_initialized;
+
+/* The counters are read with two loads, so retry if the upper half changed
+ * while the lower half was being read. */
+static u64 counter_read(const volatile u64 *const counter) {
+  const volatile u32 *const half = (const volatile u32 *)counter;
+  u32 high, low;
+  do {
+    high = half[1];
+    low = half[0];
+  } while (high != half[1]);
+  return (u64)high << 32 | low;
+}
+
+u64 millis(void) { return counter_read(&__counter_millis); }
+
+u64 micros(void) { return counter_read(&__counter_micros); }
 
-u64 micros(void) { return __counter_micros; }
+u64 nanos(void) { return counter_read(&__counter_nanos); }
 
-u64 nanos(void) { return __counter_nanos; }
+u32 millis32(void) { return *(const volatile u32 *)&__counter_millis; }
+
+u32 micros32(void) { return *(const volatile u32 *)&__counter_micros; }
+
+u32 nanos32(void) { return *(const volatile u32 *)&__counter_nanos; }
 
 void timer_set_enabled(const enum TIMER timer, const bool enabled) {
   if (enabled) {
@@ -31,8 +64,77 @@ void timer_set_interval(const enum TIMER timer, const u64 interval_us) {
   __timer_interval = interval_us;
 }
 
-void sleep(const u64 interval_ms) {
-  const u64 start = millis();
-  while (millis() - start < interval_ms)
-    ;
+static void sleep_program(void) {
+  timer_set_enabled(SLEEP_TIMER, false);
+  if (sleep_queue == NULLPTR) {
+    return;
+  }
+  const u64 now = micros();
+  u64 interval = sleep_queue->deadline > now ? sleep_queue->deadline - now : 1;
+  if (interval > SLEEP_INTERVAL_MAX) {
+    interval = SLEEP_INTERVAL_MAX;
+  }
+  timer_set_interval(SLEEP_TIMER, interval);
+  timer_set_enabled(SLEEP_TIMER, true);
+}
+
+static void sleep_insert(struct Sleeper *const sleeper) {
+  struct Sleeper **link = &sleep_queue;
+  while (*link != NULLPTR && (*link)->deadline <= sleeper->deadline) {
+    link = &(*link)->next;
+  }
+  sleeper->next = *link;
+  *link = sleeper;
+  if (sleep_queue == sleeper) {
+    sleep_program();
+  }
+}
+
+static __fast void sleep_isr(const usize irqs,
+                             union StackFrame *const stack_frame) {
+  const usize state = irq_lock();
+  const u64 now = micros();
+  while (sleep_queue != NULLPTR && sleep_queue->deadline <= now) {
+    struct Sleeper *const sleeper = sleep_queue;
+    sleep_queue = sleeper->next;
+    sleeper->expired = true;
+    sched_wake(&sleeper->waiter);
+  }
+  sleep_program();
+  irq_unlock(state);
+  sched_reschedule();
+}
+
+void sleep(const u64 interval_ms) { sleep_us(interval_ms * 1000); }
+
+void sleep_us(const u64 interval_us) {
+  struct Sleeper sleeper;
+  sleeper.deadline = micros() + interval_us;
+  sleeper.expired = false;
+  sleeper.waiter.head = NULLPTR;
+  if (irq_get_active()) {
+    while (micros() < sleeper.deadline)
+      ;
+    return;
+  }
+  if (!sleep_initialized) {
+    irq_set_handler(SLEEP_IRQ, sleep_isr);
+    irq_set_enabled(irq_get_enabled() | SLEEP_IRQ);
+    sleep_initialized = true;
+  }
+  // The caller may have set a mask without SLEEP_IRQ since it was enabled,
+  // so it is enabled while waiting and the caller's mask restored afterwards
+  const usize state = sched_lock();
+  usize waiting = state | SLEEP_IRQ;
+  sleep_insert(&sleeper);
+  while (!sleeper.expired) {
+    if (sched_get_started()) {
+      waiting = sched_block(&sleeper.waiter, waiting);
+    } else {
+      irq_wait(IRQ_ALL);
+      sched_unlock(waiting);
+      sched_lock();
+    }
+  }
+  sched_unlock(state);
 }
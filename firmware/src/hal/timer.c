@@ -0,0 +1,179 @@
+#include <stdlib.h>
+
+#include <hal/irq.h>
+#include <hal/timer.h>
+
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_SPAN ((u32)1 << (WHEEL_LEVELS * WHEEL_SLOT_BITS))
+#define WHEEL_IRQ (IRQ_TIMER0 << WHEEL_TIMER)
+
+static struct SoftTimer *(*wheel)[WHEEL_SLOTS];
+static u32 wheel_jiffies;
+static usize wheel_count;
+
+static __fast void wheel_link(struct SoftTimer **const slot,
+                              struct SoftTimer *const timer) {
+  timer->next = *slot;
+  if (*slot != NULLPTR) {
+    (*slot)->link = &timer->next;
+  }
+  timer->link = slot;
+  *slot = timer;
+}
+
+static __fast void wheel_unlink(struct SoftTimer *const timer) {
+  *timer->link = timer->next;
+  if (timer->next != NULLPTR) {
+    timer->next->link = timer->link;
+  }
+  timer->link = NULLPTR;
+}
+
+/* Each level covers WHEEL_SLOTS times the span of the one below it. Timers
+ * further away than the whole wheel wait in the last level and are placed
+ * again when it cascades. */
+static __fast void wheel_insert(struct SoftTimer *const timer) {
+  u32 expires = timer->expires;
+  const u32 delta = expires - wheel_jiffies;
+  if ((i32)delta < 0) {
+    expires = wheel_jiffies;
+  } else if (delta >= WHEEL_SPAN) {
+    expires = wheel_jiffies + WHEEL_SPAN - 1;
+  }
+  usize level = 0;
+  while (level < WHEEL_LEVELS - 1 &&
+         (expires - wheel_jiffies) >> ((level + 1) * WHEEL_SLOT_BITS)) {
+    ++level;
+  }
+  const usize slot = (expires >> (level * WHEEL_SLOT_BITS)) & WHEEL_MASK;
+  wheel_link(&wheel[level][slot], timer);
+}
+
+static __fast usize wheel_cascade(const usize level) {
+  const usize slot = (wheel_jiffies >> (level * WHEEL_SLOT_BITS)) & WHEEL_MASK;
+  struct SoftTimer *timer = wheel[level][slot];
+  wheel[level][slot] = NULLPTR;
+  while (timer != NULLPTR) {
+    struct SoftTimer *const next = timer->next;
+    wheel_insert(timer);
+    timer = next;
+  }
+  return slot;
+}
+
+/* The whole slot is detached and expired as a batch. Callbacks may start or
+ * cancel any timer, including those still waiting in the batch, and run
+ * unlocked when the handler is nested. */
+static __fast void wheel_isr(const usize irqs,
+                             union StackFrame *const stack_frame) {
+  const usize state = irq_lock();
+  const usize slot = wheel_jiffies & WHEEL_MASK;
+  if (slot == 0) {
+    for (usize level = 1; level < WHEEL_LEVELS; ++level) {
+      if (wheel_cascade(level) != 0) {
+        break;
+      }
+    }
+  }
+  struct SoftTimer *expired = wheel[0][slot];
+  wheel[0][slot] = NULLPTR;
+  if (expired != NULLPTR) {
+    expired->link = &expired;
+  }
+  ++wheel_jiffies;
+  while (expired != NULLPTR) {
+    struct SoftTimer *const timer = expired;
+    wheel_unlink(timer);
+    if (timer->period) {
+      timer->expires += timer->period;
+      wheel_insert(timer);
+    } else {
+      --wheel_count;
+    }
+    const soft_timer_fn callback = timer->callback;
+    void *const argument = timer->argument;
+    irq_unlock(state);
+    callback(timer, argument);
+    irq_lock();
+  }
+  if (wheel_count == 0) {
+    timer_set_enabled(WHEEL_TIMER, false);
+  }
+  irq_unlock(state);
+}
+
+static bool wheel_init(void) {
+  if (wheel == NULLPTR) {
+    wheel = calloc(WHEEL_LEVELS, sizeof(*wheel));
+    if (wheel == NULLPTR) {
+      return false;
+    }
+    irq_set_handler(WHEEL_IRQ, wheel_isr);
+  }
+  return true;
+}
+
+static u32 wheel_ticks(const u32 interval_ms) {
+  return (u64)interval_ms * 1000 / WHEEL_TICK;
+}
+
+static void timer_start(struct SoftTimer *const timer, const u32 delay,
+                        const u32 period, const soft_timer_fn callback,
+                        void *const argument) {
+  const usize enabled = irq_set_enabled(IRQ_NONE);
+  if (!wheel_init()) {
+    irq_set_enabled(enabled);
+    return;
+  }
+  if (timer->link != NULLPTR) {
+    wheel_unlink(timer);
+  } else {
+    ++wheel_count;
+  }
+  timer->expires = wheel_jiffies + delay;
+  timer->period = period;
+  timer->callback = callback;
+  timer->argument = argument;
+  wheel_insert(timer);
+  if (!timer_get_enabled(WHEEL_TIMER)) {
+    timer_set_interval(WHEEL_TIMER, WHEEL_TICK);
+    timer_set_enabled(WHEEL_TIMER, true);
+  }
+  irq_set_enabled(enabled | WHEEL_IRQ);
+}
+
+void timer_init(struct SoftTimer *const timer) {
+  timer->next = NULLPTR;
+  timer->link = NULLPTR;
+}
+
+void timer_start_oneshot(struct SoftTimer *const timer, const u32 delay_ms,
+                         const soft_timer_fn callback, void *const argument) {
+  timer_start(timer, wheel_ticks(delay_ms), 0, callback, argument);
+}
+
+void timer_start_periodic(struct SoftTimer *const timer, const u32 period_ms,
+                          const soft_timer_fn callback, void *const argument) {
+  u32 period = wheel_ticks(period_ms);
+  if (period == 0) {
+    period = 1;
+  }
+  timer_start(timer, period - 1, period, callback, argument);
+}
+
+bool timer_cancel(struct SoftTimer *const timer) {
+  const usize enabled = irq_set_enabled(IRQ_NONE);
+  const bool active = timer->link != NULLPTR;
+  if (active) {
+    wheel_unlink(timer);
+    --wheel_count;
+  }
+  irq_set_enabled(enabled);
+  return active;
+}
+
+bool timer_get_active(const struct SoftTimer *const timer) {
+  return timer->link != NULLPTR;
+}
+
+usize timer_get_count(void) { return wheel_count; }
@@ -1,5 +1,11 @@
+#include <hal/irq.h>
 #include <hal/uart.h>
 
+#define UART_PORT_COUNT 2
+#define UART_BUFFER_MASK (UART_BUFFER_SIZE - 1)
+#define UART_LEVEL_MASK 0xFFFF
+#define UART_LEVEL_OVERRUN (1 << 31)
+
 extern const volatile bool __uart0_rx_ready;
 extern const volatile bool __uart0_tx_ready;
 extern const volatile u8 __uart0_rx;
@@ -10,7 +16,192 @@ extern const volatile bool __uart1_tx_ready;
 extern const volatile u8 __uart1_rx;
 extern volatile u8 __uart1_tx;
 
+extern const volatile usize __uart0_rx_level;
+extern const volatile usize __uart0_tx_level;
+extern const volatile usize __uart1_rx_level;
+extern const volatile usize __uart1_tx_level;
+extern const volatile usize __uart_fifo_depth;
+
+struct RingBuffer {
+  volatile usize head;
+  volatile usize tail;
+  volatile u8 data[UART_BUFFER_SIZE];
+};
+
+static struct RingBuffer uart_rx_buffer[UART_PORT_COUNT];
+static struct RingBuffer uart_tx_buffer[UART_PORT_COUNT];
+static volatile bool uart_async[UART_PORT_COUNT];
+static volatile bool uart_overrun[UART_PORT_COUNT];
+static usize uart_fifo_depth;
+
+static inline usize ring_count(const struct RingBuffer *const ring) {
+  return ring->head - ring->tail;
+}
+
+static inline bool ring_push(struct RingBuffer *const ring, const u8 value) {
+  const usize head = ring->head;
+  if (head - ring->tail == UART_BUFFER_SIZE) {
+    return false;
+  }
+  ring->data[head & UART_BUFFER_MASK] = value;
+  ring->head = head + 1;
+  return true;
+}
+
+static inline bool ring_pop(struct RingBuffer *const ring, u8 *const value) {
+  const usize tail = ring->tail;
+  if (ring->head == tail) {
+    return false;
+  }
+  *value = ring->data[tail & UART_BUFFER_MASK];
+  ring->tail = tail + 1;
+  return true;
+}
+
+static inline bool uart_rx_ready(const enum UART_PORT port) {
+  return port == UART0 ? __uart0_rx_ready : __uart1_rx_ready;
+}
+
+static inline bool uart_tx_ready(const enum UART_PORT port) {
+  return port == UART0 ? __uart0_tx_ready : __uart1_tx_ready;
+}
+
+static inline u8 uart_rx_read(const enum UART_PORT port) {
+  return port == UART0 ? __uart0_rx : __uart1_rx;
+}
+
+static inline void uart_tx_write(const enum UART_PORT port, const u8 value) {
+  if (port == UART0) {
+    __uart0_tx = value;
+  } else {
+    __uart1_tx = value;
+  }
+}
+
+static inline usize uart_rx_level(const enum UART_PORT port) {
+  const usize level = port == UART0 ? __uart0_rx_level : __uart1_rx_level;
+  if (level & UART_LEVEL_OVERRUN) {
+    uart_overrun[port] = true;
+  }
+  return level & UART_LEVEL_MASK;
+}
+
+static inline usize uart_tx_level(const enum UART_PORT port) {
+  return (port == UART0 ? __uart0_tx_level : __uart1_tx_level) &
+         UART_LEVEL_MASK;
+}
+
+/* Move bytes between the hardware FIFOs and the ring buffers in bursts
+ * sized by the FIFO fill levels. Only ever called under irq_lock, so each
+ * ring keeps a single producer and a single consumer, and no handler can
+ * change the IRQ mask while it is taken. */
+
+static __fast void uart_rx_pump(const enum UART_PORT port) {
+  struct RingBuffer *const ring = &uart_rx_buffer[port];
+  const usize space = UART_BUFFER_SIZE - ring_count(ring);
+  const usize level = uart_rx_level(port);
+  for (usize n = level < space ? level : space; n > 0; --n) {
+    ring_push(ring, uart_rx_read(port));
+  }
+}
+
+static __fast void uart_tx_pump(const enum UART_PORT port) {
+  struct RingBuffer *const ring = &uart_tx_buffer[port];
+  u8 value;
+  for (usize space = uart_fifo_depth - uart_tx_level(port); space > 0;
+       --space) {
+    if (!ring_pop(ring, &value)) {
+      break;
+    }
+    uart_tx_write(port, value);
+  }
+}
+
+static void uart_rx_kick(const enum UART_PORT port) {
+  const usize state = irq_lock();
+  uart_rx_pump(port);
+  irq_unlock(state);
+}
+
+static void uart_tx_kick(const enum UART_PORT port) {
+  const usize state = irq_lock();
+  uart_tx_pump(port);
+  irq_unlock(state);
+}
+
+static __fast void uart_rx_isr(const usize irqs,
+                               union StackFrame *const stack_frame) {
+  const usize state = irq_lock();
+  for (usize port = 0; port < UART_PORT_COUNT; ++port) {
+    if (uart_async[port]) {
+      uart_rx_pump(port);
+    }
+  }
+  irq_unlock(state);
+}
+
+static __fast void uart_tx_isr(const usize irqs,
+                               union StackFrame *const stack_frame) {
+  const usize state = irq_lock();
+  for (usize port = 0; port < UART_PORT_COUNT; ++port) {
+    if (uart_async[port]) {
+      uart_tx_pump(port);
+    }
+  }
+  irq_unlock(state);
+}
+
+void uart_set_async(const enum UART_PORT port, const bool enabled) {
+  if (uart_async[port] == enabled) {
+    return;
+  }
+  if (enabled) {
+    uart_rx_buffer[port].head = uart_rx_buffer[port].tail = 0;
+    uart_tx_buffer[port].head = uart_tx_buffer[port].tail = 0;
+    uart_fifo_depth = __uart_fifo_depth;
+    uart_async[port] = true;
+    // Bursts are read on the threshold, and their tail once the line is
+    // idle, so IRQ_UART_RX_READY stays masked instead of firing per byte
+    irq_set_handler(IRQ_UART_RX_THRESHOLD, uart_rx_isr);
+    irq_set_handler(IRQ_UART_RX_IDLE, uart_rx_isr);
+    irq_set_handler(IRQ_UART_TX_THRESHOLD, uart_tx_isr);
+    irq_set_priority(IRQ_UART_RX_THRESHOLD | IRQ_UART_RX_IDLE,
+                     IRQ_PRIORITY_HIGH);
+    irq_set_enabled((irq_get_enabled() & ~IRQ_UART_RX_READY) |
+                    IRQ_UART_RX_THRESHOLD | IRQ_UART_RX_IDLE |
+                    IRQ_UART_TX_THRESHOLD);
+  } else {
+    while (ring_count(&uart_tx_buffer[port]) > 0) {
+      uart_tx_kick(port);
+    }
+    uart_async[port] = false;
+    if (!uart_async[UART0] && !uart_async[UART1]) {
+      irq_set_enabled(irq_get_enabled() &
+                      ~(IRQ_UART_RX_THRESHOLD | IRQ_UART_RX_IDLE |
+                        IRQ_UART_TX_THRESHOLD));
+    }
+  }
+}
+
+bool uart_get_async(const enum UART_PORT port) { return uart_async[port]; }
+
+bool uart_get_overrun(const enum UART_PORT port) {
+  uart_rx_level(port);
+  const bool overrun = uart_overrun[port];
+  uart_overrun[port] = false;
+  return overrun;
+}
+
+usize uart_tx_pending(const enum UART_PORT port) {
+  return uart_async[port] ? ring_count(&uart_tx_buffer[port]) : 0;
+}
+
 void put_ch(const enum UART_PORT port, const char character) {
+  if (uart_async[port]) {
+    while (!put_buff_async(port, &character, 1))
+      ;
+    return;
+  }
   switch (port) {
   case UART0:
     while (!__uart0_tx_ready)
@@ -26,6 +217,12 @@ void put_ch(const enum UART_PORT port, const char character) {
 }
 
 char get_ch(const enum UART_PORT port) {
+  if (uart_async[port]) {
+    char character;
+    while (!get_buff_async(port, &character, 1))
+      ;
+    return character;
+  }
   switch (port) {
   case UART0:
     while (!__uart0_rx_ready)
@@ -42,6 +239,12 @@ char get_ch(const enum UART_PORT port) {
 
 void put_buff(const enum UART_PORT port, const char *const buffer,
               const usize length) {
+  if (uart_async[port]) {
+    for (usize sent = 0; sent < length;) {
+      sent += put_buff_async(port, buffer + sent, length - sent);
+    }
+    return;
+  }
   for (usize i = 0; i < length; ++i) {
     put_ch(port, buffer[i]);
   }
@@ -49,7 +252,53 @@ void put_buff(const enum UART_PORT port, const char *const buffer,
 
 void get_buff(const enum UART_PORT port, char *const buffer,
               const usize length) {
+  if (uart_async[port]) {
+    for (usize received = 0; received < length;) {
+      received += get_buff_async(port, buffer + received, length - received);
+    }
+    return;
+  }
   for (usize i = 0; i < length; ++i) {
     buffer[i] = get_ch(port);
   }
 }
+
+usize put_buff_async(const enum UART_PORT port, const char *const buffer,
+                     const usize length) {
+  usize queued = 0;
+  if (!uart_async[port]) {
+    while (queued < length && uart_tx_ready(port)) {
+      uart_tx_write(port, buffer[queued++]);
+    }
+    return queued;
+  }
+  struct RingBuffer *const ring = &uart_tx_buffer[port];
+  while (queued < length && ring_push(ring, buffer[queued])) {
+    ++queued;
+  }
+  uart_tx_kick(port);
+  return queued;
+}
+
+usize get_buff_async(const enum UART_PORT port, char *const buffer,
+                     const usize length) {
+  usize received = 0;
+  if (!uart_async[port]) {
+    while (received < length && uart_rx_ready(port)) {
+      buffer[received++] = uart_rx_read(port);
+    }
+    return received;
+  }
+  struct RingBuffer *const ring = &uart_rx_buffer[port];
+  u8 value;
+  while (received < length && ring_pop(ring, &value)) {
+    buffer[received++] = value;
+  }
+  if (received < length) {
+    uart_rx_kick(port);
+    while (received < length && ring_pop(ring, &value)) {
+      buffer[received++] = value;
+    }
+  }
+  return received;
+}
@@ -0,0 +1,56 @@
+`timescale 1 ns / 1 ps
+
+// Behavioral replacement for the altsyncram based MEM_BRAM, with the same
+// Wishbone timing. Contents are loaded from the +bram=<file> plusarg.
+module MEM_BRAM #(
+	parameter	RAM_SIZE = 12288 // 48KiB
+) (
+	input					clk,
+	input					rst_n,
+	input					i_wb_cyc,
+	input					i_wb_stb,
+	input					i_wb_we,
+	input		[31:0]	i_wb_addr,
+	input		[31:0]	i_wb_data,
+	input		[3:0]		i_wb_sel,
+	output				o_wb_stall,
+	output				o_wb_ack,
+	output reg	[31:0]	o_wb_data
+);
+
+	localparam	ADDR_LEN = $clog2(RAM_SIZE);
+
+	reg [31:0]	s_ram [0:RAM_SIZE - 1];
+	reg			s_wb_ack;
+	reg [2047:0]	s_init_file;
+
+	wire [ADDR_LEN - 1:0] s_ram_addr =
+		i_wb_addr < RAM_SIZE * 4 ? i_wb_addr[ADDR_LEN + 1:2] : {ADDR_LEN{1'b0}};
+
+	initial begin
+		if ($value$plusargs("bram=%s", s_init_file))
+			$readmemh(s_init_file, s_ram);
+	end
+
+	always @(posedge clk) begin
+		if (i_wb_stb && i_wb_we) begin
+			if (i_wb_sel[0]) s_ram[s_ram_addr][7:0] <= i_wb_data[7:0];
+			if (i_wb_sel[1]) s_ram[s_ram_addr][15:8] <= i_wb_data[15:8];
+			if (i_wb_sel[2]) s_ram[s_ram_addr][23:16] <= i_wb_data[23:16];
+			if (i_wb_sel[3]) s_ram[s_ram_addr][31:24] <= i_wb_data[31:24];
+		end else if (i_wb_stb) begin
+			o_wb_data <= s_ram[s_ram_addr];
+		end
+	end
+
+	always @(posedge clk) begin
+		if (!rst_n)
+			s_wb_ack <= 1'b0;
+		else
+			s_wb_ack <= i_wb_stb && i_wb_cyc;
+	end
+
+	assign o_wb_ack = s_wb_ack && i_wb_stb;
+	assign o_wb_stall = 1'b0;
+
+endmodule
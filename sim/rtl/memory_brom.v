@@ -0,0 +1,50 @@
+`timescale 1 ns / 1 ps
+
+// Behavioral replacement for the altsyncram based MEM_BROM, with the same
+// Wishbone timing. Contents are loaded from the +brom=<file> plusarg.
+module MEM_BROM #(
+	parameter	ROM_SIZE = 1024 // 4KiB
+) (
+	input					clk,
+	input					rst_n,
+	input					i_wb_cyc,
+	input					i_wb_stb,
+	input					i_wb_we,
+	input		[31:0]	i_wb_addr,
+	input		[31:0]	i_wb_data,
+	input		[3:0]		i_wb_sel,
+	output				o_wb_stall,
+	output				o_wb_ack,
+	output reg	[31:0]	o_wb_data
+);
+
+	localparam	ADDR_LEN = $clog2(ROM_SIZE);
+
+	reg [31:0]	s_rom [0:ROM_SIZE - 1];
+	reg			s_wb_ack;
+	reg [2047:0]	s_init_file;
+
+	wire [ADDR_LEN - 1:0] s_rom_addr =
+		i_wb_addr < ROM_SIZE * 4 ? i_wb_addr[ADDR_LEN + 1:2] : {ADDR_LEN{1'b0}};
+
+	initial begin
+		if ($value$plusargs("brom=%s", s_init_file))
+			$readmemh(s_init_file, s_rom);
+	end
+
+	always @(posedge clk) begin
+		if (i_wb_stb && !i_wb_we)
+			o_wb_data <= s_rom[s_rom_addr];
+	end
+
+	always @(posedge clk) begin
+		if (!rst_n)
+			s_wb_ack <= 1'b0;
+		else
+			s_wb_ack <= i_wb_stb && i_wb_cyc;
+	end
+
+	assign o_wb_ack = s_wb_ack && i_wb_stb;
+	assign o_wb_stall = 1'b0;
+
+endmodule
@@ -0,0 +1,112 @@
+`timescale 1 ns / 1 ps
+
+// Behavioral model of the 8 MiB x16 SDR SDRAM on the MAX1000 board.
+// Commands are sampled on the rising edge and bursts are sequential. Read
+// data changes on the edge CAS latency cycles after the read command, one
+// edge later than on the board, which is what the extra input register in
+// wbsdram under VERILATOR expects. Contents are loaded from the
+// +sdram=<file> plusarg, with one 16-bit word per {bank, row, column}.
+module sdram_model #(
+	parameter	BS_LEN = 2,
+	parameter	ROW_LEN = 12,
+	parameter	COL_LEN = 8
+) (
+	input						i_clk,
+	input						i_cs_n,
+	input						i_ras_n,
+	input						i_cas_n,
+	input						i_we_n,
+	input		[1:0]			i_bs,
+	input		[11:0]		i_addr,
+	input		[1:0]			i_dqm,
+	inout		[15:0]		io_data
+);
+
+	localparam	INDEX_LEN = BS_LEN + ROW_LEN + COL_LEN;
+	localparam	PIPE_LEN = 16;
+
+	reg [15:0]	s_ram [0:(1 << INDEX_LEN) - 1];
+	reg [ROW_LEN - 1:0]	s_row [0:(1 << BS_LEN) - 1];
+
+	reg [2:0]	s_cas_latency = 3'd2;
+	reg [3:0]	s_burst_len = 4'd1;
+
+	reg [PIPE_LEN - 1:0]	s_read_valid = 0;
+	reg [INDEX_LEN - 1:0]	s_read_index [0:PIPE_LEN - 1];
+
+	reg [3:0]	s_write_left = 4'd0;
+	reg [INDEX_LEN - 1:0]	s_write_index;
+	reg [COL_LEN - 1:0]	s_write_col;
+
+	reg			s_drive = 1'b0;
+	reg [15:0]	s_data_o;
+	reg [2047:0]	s_init_file;
+
+	wire s_cmd_active = !i_cs_n && !i_ras_n && i_cas_n && i_we_n;
+	wire s_cmd_read = !i_cs_n && i_ras_n && !i_cas_n && i_we_n;
+	wire s_cmd_write = !i_cs_n && i_ras_n && !i_cas_n && !i_we_n;
+	wire s_cmd_mode = !i_cs_n && !i_ras_n && !i_cas_n && !i_we_n;
+
+	wire [COL_LEN - 1:0]	s_burst_mask = s_burst_len - 1;
+
+	integer i;
+
+	initial begin
+		if ($value$plusargs("sdram=%s", s_init_file))
+			$readmemh(s_init_file, s_ram);
+	end
+
+	function [COL_LEN - 1:0] burst_col(input [COL_LEN - 1:0] start, input integer beat);
+		burst_col = (start & ~s_burst_mask) | ((start + beat) & s_burst_mask);
+	endfunction
+
+	always @(posedge i_clk) begin
+		for (i = 0; i < PIPE_LEN - 1; i = i + 1) begin
+			s_read_valid[i] <= s_read_valid[i + 1];
+			s_read_index[i] <= s_read_index[i + 1];
+		end
+		s_read_valid[PIPE_LEN - 1] <= 1'b0;
+
+		if (s_cmd_active)
+			s_row[i_bs] <= i_addr[ROW_LEN - 1:0];
+
+		if (s_cmd_mode) begin
+			s_cas_latency <= i_addr[6:4];
+			s_burst_len <= i_addr[2:0] == 3'b000 ? 4'd1 :
+								i_addr[2:0] == 3'b001 ? 4'd2 :
+								i_addr[2:0] == 3'b010 ? 4'd4 : 4'd8;
+		end
+
+		if (s_cmd_read) begin
+			s_write_left <= 4'd0;
+			for (i = 0; i < 8; i = i + 1) begin
+				if (i < s_burst_len) begin
+					s_read_valid[s_cas_latency - 1 + i] <= 1'b1;
+					s_read_index[s_cas_latency - 1 + i] <=
+						{i_bs, s_row[i_bs], burst_col(i_addr[COL_LEN - 1:0], i)};
+				end
+			end
+		end
+
+		if (s_cmd_write || s_write_left != 0) begin
+			if (s_cmd_write) begin
+				s_write_index = {i_bs, s_row[i_bs], i_addr[COL_LEN - 1:0]};
+				s_write_col = i_addr[COL_LEN - 1:0];
+				s_write_left <= s_burst_len - 4'd1;
+				s_read_valid <= 0;
+			end else begin
+				s_write_index[COL_LEN - 1:0] =
+					burst_col(s_write_col, s_burst_len - s_write_left);
+				s_write_left <= s_write_left - 4'd1;
+			end
+			if (!i_dqm[0]) s_ram[s_write_index][7:0] <= io_data[7:0];
+			if (!i_dqm[1]) s_ram[s_write_index][15:8] <= io_data[15:8];
+		end
+
+		s_drive <= s_read_valid[0];
+		s_data_o <= s_ram[s_read_index[0]];
+	end
+
+	assign io_data = s_drive ? s_data_o : 16'bZ;
+
+endmodule
@@ -0,0 +1,26 @@
+`timescale 1 ns / 1 ps
+
+// The simulated board is clocked at the 50 MHz system frequency directly,
+// so the PLL only delays lock until a few cycles after reset.
+module sdram_pll (
+	input			areset,
+	input			inclk0,
+	output		c0,
+	output		c1,
+	output		locked
+);
+
+	reg [3:0]	s_lock_count = 4'h0;
+
+	always @(posedge inclk0 or posedge areset) begin
+		if (areset)
+			s_lock_count <= 4'h0;
+		else if (!s_lock_count[3])
+			s_lock_count <= s_lock_count + 4'h1;
+	end
+
+	assign c0 = inclk0;
+	assign c1 = ~inclk0;
+	assign locked = s_lock_count[3];
+
+endmodule
@@ -0,0 +1,85 @@
+`timescale 1 ns / 1 ps
+
+// Simulation wrapper that connects the SoC to the SDRAM model and exposes
+// the CPU state the harness needs to stop the simulation.
+module sim_top (
+	input				i_clk,
+	input				i_rst,
+
+	input	  [7:0]	i_sw,
+	input	  [4:0]	i_pb,
+	output  [7:0]	o_led,
+	output  [7:0]	o_n_col_or_7segm,
+	output  [2:0]	o_mux_row_or_digit,
+	output  [1:0]	o_mux_sel_color_or_7segm,
+	output  [2:0]	o_sem,
+
+	input				i_serial_rx,
+	output			o_serial_tx,
+	input				i_serial_ndtr,
+	input				i_uart_rx,
+	output			o_uart_tx,
+
+	output			o_trap,
+	output			o_halt
+);
+
+	wire			s_ram_cs_n;
+	wire			s_ram_ras_n;
+	wire			s_ram_cas_n;
+	wire			s_ram_we_n;
+	wire  [1:0]	s_ram_bs;
+	wire [11:0]	s_ram_addr;
+	wire [15:0]	s_ram_data;
+	wire  [1:0]	s_ram_dqm;
+
+	top soc (
+		.i_clk				(i_clk),
+		.i_rst				(i_rst),
+		.i_sw					(i_sw),
+		.i_pb					(i_pb),
+		.o_led				(o_led),
+		.o_n_col_or_7segm	(o_n_col_or_7segm),
+		.o_mux_row_or_digit
+								(o_mux_row_or_digit),
+		.o_mux_sel_color_or_7segm
+								(o_mux_sel_color_or_7segm),
+		.o_sem				(o_sem),
+		.i_serial_rx		(i_serial_rx),
+		.o_serial_tx		(o_serial_tx),
+		.o_serial_ndsr		(),
+		.o_serial_ncts		(),
+		.i_serial_nrts		(1'b1),
+		.i_serial_ndtr		(i_serial_ndtr),
+		.i_uart_rx			(i_uart_rx),
+		.o_uart_tx			(o_uart_tx),
+		.o_ram_clk			(),
+		.o_ram_cs_n			(s_ram_cs_n),
+		.o_ram_cke			(),
+		.o_ram_ras_n		(s_ram_ras_n),
+		.o_ram_cas_n		(s_ram_cas_n),
+		.o_ram_we_n			(s_ram_we_n),
+		.o_ram_bs			(s_ram_bs),
+		.o_ram_addr			(s_ram_addr),
+		.io_ram_data		(s_ram_data),
+		.o_ram_dqm			(s_ram_dqm)
+	);
+
+	sdram_model sdram (
+		.i_clk				(i_clk),
+		.i_cs_n				(s_ram_cs_n),
+		.i_ras_n				(s_ram_ras_n),
+		.i_cas_n				(s_ram_cas_n),
+		.i_we_n				(s_ram_we_n),
+		.i_bs					(s_ram_bs),
+		.i_addr				(s_ram_addr),
+		.i_dqm				(s_ram_dqm),
+		.io_data				(s_ram_data)
+	);
+
+	// A fetched `j .` is how __exit and other terminal loops halt
+	assign o_trap = soc.trap;
+	assign o_halt = soc.picorv32.mem_ready && soc.picorv32.mem_instr &&
+						 soc.picorv32.mem_rdata == 32'h0000_006f;
+
+endmodule
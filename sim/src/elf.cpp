@@ -0,0 +1,129 @@
+#include "elf.hpp"
+
+#include <cstdio>
+#include <elf.h>
+#include <fstream>
+#include <iterator>
+
+bool MemoryImage::empty(void) const {
+  for (const bool byte : loaded) {
+    if (byte) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint32_t MemoryImage::word(const uint32_t offset) const {
+  return bytes[offset] | bytes[offset + 1] << 8 | bytes[offset + 2] << 16 |
+         bytes[offset + 3] << 24;
+}
+
+void MemoryImage::store(const uint32_t offset, const uint32_t value) {
+  for (uint32_t i = 0; i < 4; ++i) {
+    bytes[offset + i] = value >> (8 * i);
+    loaded[offset + i] = true;
+  }
+}
+
+static MemoryImage *image_region(SocImage &image, const uint32_t address) {
+  for (MemoryImage *const memory : {&image.bram, &image.brom, &image.sdram}) {
+    if (address >= memory->start &&
+        address - memory->start < memory->bytes.size()) {
+      return memory;
+    }
+  }
+  return nullptr;
+}
+
+std::string elf_load(const std::string &path, SocImage &image) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return path + ": cannot open file";
+  }
+  const std::vector<uint8_t> elf{std::istreambuf_iterator<char>(file), {}};
+  if (elf.size() < sizeof(Elf32_Ehdr)) {
+    return path + ": not an ELF file";
+  }
+  const Elf32_Ehdr *const header = (const Elf32_Ehdr *)elf.data();
+  if (std::string((const char *)header->e_ident, SELFMAG) != ELFMAG ||
+      header->e_ident[EI_CLASS] != ELFCLASS32 ||
+      header->e_ident[EI_DATA] != ELFDATA2LSB ||
+      header->e_machine != EM_RISCV) {
+    return path + ": not a little-endian RV32 ELF file";
+  }
+  if (header->e_phoff + (uint64_t)header->e_phnum * sizeof(Elf32_Phdr) >
+      elf.size()) {
+    return path + ": truncated program headers";
+  }
+  const Elf32_Phdr *const segments =
+      (const Elf32_Phdr *)(elf.data() + header->e_phoff);
+  for (uint32_t i = 0; i < header->e_phnum; ++i) {
+    const Elf32_Phdr &segment = segments[i];
+    if (segment.p_type != PT_LOAD || segment.p_filesz == 0) {
+      continue;
+    }
+    if ((uint64_t)segment.p_offset + segment.p_filesz > elf.size()) {
+      return path + ": truncated segment";
+    }
+    for (uint32_t byte = 0; byte < segment.p_filesz; ++byte) {
+      const uint32_t address = segment.p_paddr + byte;
+      MemoryImage *const memory = image_region(image, address);
+      if (memory == nullptr) {
+        char message[64];
+        std::snprintf(message, sizeof(message),
+                      ": segment byte at 0x%05x is not in memory", address);
+        return path + message;
+      }
+      memory->bytes[address - memory->start] = elf[segment.p_offset + byte];
+      memory->loaded[address - memory->start] = true;
+    }
+  }
+  return "";
+}
+
+static bool word_loaded(const MemoryImage &memory, const uint32_t offset) {
+  return memory.loaded[offset] || memory.loaded[offset + 1] ||
+         memory.loaded[offset + 2] || memory.loaded[offset + 3];
+}
+
+bool hex_write_words(const std::string &path, const MemoryImage &memory) {
+  FILE *const file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    return false;
+  }
+  bool contiguous = false;
+  for (uint32_t offset = 0; offset < memory.bytes.size(); offset += 4) {
+    if (!word_loaded(memory, offset)) {
+      contiguous = false;
+      continue;
+    }
+    if (!contiguous) {
+      std::fprintf(file, "@%x\n", offset >> 2);
+      contiguous = true;
+    }
+    std::fprintf(file, "%08x\n", memory.word(offset));
+  }
+  return std::fclose(file) == 0;
+}
+
+bool hex_write_sdram(const std::string &path, const MemoryImage &memory) {
+  FILE *const file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    return false;
+  }
+  for (uint32_t offset = 0; offset < memory.bytes.size(); offset += 4) {
+    if (!word_loaded(memory, offset)) {
+      continue;
+    }
+    // wbsdram takes the byte offset as its 21-bit word address
+    const uint32_t address = offset & 0x1FFFFF;
+    const uint32_t bank = address >> 7 & 0x3;
+    const uint32_t row = address >> 9 & 0xFFF;
+    const uint32_t column = (address & 0x7F) << 1;
+    const uint32_t value = memory.word(offset);
+    std::fprintf(file, "@%x\n%04x\n%04x\n", bank << 20 | row << 8 | column,
+                 value >> 16, value & 0xFFFF);
+  }
+  return std::fclose(file) == 0;
+}
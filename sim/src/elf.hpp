@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define BRAM_START 0x00000
+#define BRAM_END 0x0C000
+#define BROM_START 0x10000
+#define BROM_END 0x11000
+#define SDRAM_START 0x11000
+#define SDRAM_END 0x100000
+
+struct MemoryImage {
+  std::vector<uint8_t> bytes;
+  std::vector<bool> loaded;
+  uint32_t start;
+
+  MemoryImage(const uint32_t start, const uint32_t end)
+      : bytes(end - start), loaded(end - start), start(start) {}
+
+  bool empty(void) const;
+  uint32_t word(const uint32_t offset) const;
+  void store(const uint32_t offset, const uint32_t value);
+};
+
+struct SocImage {
+  MemoryImage bram{BRAM_START, BRAM_END};
+  MemoryImage brom{BROM_START, BROM_END};
+  MemoryImage sdram{SDRAM_START, SDRAM_END};
+};
+
+/* Copies the loadable segments of an ELF file into the memories they are
+ * linked at, returning an error message on failure. */
+std::string elf_load(const std::string &path, SocImage &image);
+
+/* Writes $readmemh files for the simulation memory models. SDRAM words are
+ * stored by the {bank, row, column} address wbsdram generates for them. */
+bool hex_write_words(const std::string &path, const MemoryImage &memory);
+bool hex_write_sdram(const std::string &path, const MemoryImage &memory);
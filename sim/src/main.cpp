@@ -0,0 +1,211 @@
+#include "Vsim_top.h"
+#include "elf.hpp"
+#include "uart.hpp"
+#include "verilated.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+#define CLK_FREQ_HZ 50000000
+#define RESET_CYCLES 16
+
+// Baud rates are fixed in peripherals.vhd
+#define UART0_CLOCKS_PER_BIT (CLK_FREQ_HZ / 115200)
+#define UART1_CLOCKS_PER_BIT (CLK_FREQ_HZ / 2000000)
+
+static const char usage[] =
+    "Usage: sim [options] [firmware.elf]\n"
+    "  -b ELF     boot from this bootloader instead of jumping to BRAM\n"
+    "  -c CYCLES  stop after this many cycles\n"
+    "  -i CYCLES  stop once the UARTs were idle for this many cycles\n"
+    "  -u PATH    connect UART0 to a file, FIFO or pseudo-terminal\n"
+    "  -q         do not print the summary\n"
+    "UART1 is connected to stdin and stdout.\n";
+
+static volatile std::sig_atomic_t interrupted = 0;
+
+static void interrupt(const int) { interrupted = 1; }
+
+/* jal x0, offset */
+static uint32_t jump(const int32_t offset) {
+  const uint32_t imm = offset;
+  return (imm & 0x100000) << 11 | (imm & 0x7FE) << 20 | (imm & 0x800) << 9 |
+         (imm & 0xFF000) | 0x6F;
+}
+
+static std::string temp_dir;
+
+static void remove_temp_dir(void) {
+  for (const char *name : {"bram.hex", "brom.hex", "sdram.hex"}) {
+    unlink((temp_dir + "/" + name).c_str());
+  }
+  rmdir(temp_dir.c_str());
+}
+
+int main(int argc, char **argv) {
+  std::string firmware = "../firmware/build/firmware.elf";
+  std::string bootloader;
+  std::string uart0_path;
+  uint64_t max_cycles = 0;
+  uint64_t idle_cycles = 0;
+  bool quiet = false;
+
+  int option;
+  while ((option = getopt(argc, argv, "b:c:i:u:qh")) != -1) {
+    switch (option) {
+    case 'b':
+      bootloader = optarg;
+      break;
+    case 'c':
+      max_cycles = std::strtoull(optarg, nullptr, 0);
+      break;
+    case 'i':
+      idle_cycles = std::strtoull(optarg, nullptr, 0);
+      break;
+    case 'u':
+      uart0_path = optarg;
+      break;
+    case 'q':
+      quiet = true;
+      break;
+    default:
+      std::fputs(usage, stderr);
+      return option == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+  }
+  if (optind < argc) {
+    firmware = argv[optind];
+  }
+
+  SocImage image;
+  std::string error = elf_load(firmware, image);
+  if (error.empty() && !bootloader.empty()) {
+    error = elf_load(bootloader, image);
+  }
+  if (error.empty() && image.brom.empty()) {
+    image.brom.store(0, jump(BRAM_START - BROM_START));
+  }
+  if (!error.empty()) {
+    std::fprintf(stderr, "sim: %s\n", error.c_str());
+    return EXIT_FAILURE;
+  }
+
+  char temp_template[] = "/tmp/ftn-riscv-sim.XXXXXX";
+  if (mkdtemp(temp_template) == nullptr) {
+    std::perror("sim: mkdtemp");
+    return EXIT_FAILURE;
+  }
+  temp_dir = temp_template;
+  std::atexit(remove_temp_dir);
+  const std::string bram_arg = "+bram=" + temp_dir + "/bram.hex";
+  const std::string brom_arg = "+brom=" + temp_dir + "/brom.hex";
+  const std::string sdram_arg = "+sdram=" + temp_dir + "/sdram.hex";
+  if (!hex_write_words(bram_arg.substr(6), image.bram) ||
+      !hex_write_words(brom_arg.substr(6), image.brom) ||
+      !hex_write_sdram(sdram_arg.substr(7), image.sdram)) {
+    std::perror("sim: writing memory images");
+    return EXIT_FAILURE;
+  }
+
+  int uart0_fd = -1;
+  if (!uart0_path.empty()) {
+    uart0_fd = open(uart0_path.c_str(), O_RDWR | O_NONBLOCK | O_NOCTTY);
+    if (uart0_fd < 0) {
+      std::perror(("sim: " + uart0_path).c_str());
+      return EXIT_FAILURE;
+    }
+  }
+  fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+  UartPipe uart0(UART0_CLOCKS_PER_BIT, uart0_fd, uart0_fd);
+  UartPipe uart1(UART1_CLOCKS_PER_BIT, STDIN_FILENO, STDOUT_FILENO);
+
+  const std::unique_ptr<VerilatedContext> context{new VerilatedContext};
+  const char *const plusargs[] = {argv[0], bram_arg.c_str(), brom_arg.c_str(),
+                                  sdram_arg.c_str()};
+  context->commandArgs(4, plusargs);
+  const std::unique_ptr<Vsim_top> top{new Vsim_top{context.get()}};
+
+  std::signal(SIGINT, interrupt);
+  std::signal(SIGTERM, interrupt);
+
+  top->i_clk = 0;
+  top->i_rst = 1;
+  top->i_sw = 0;
+  top->i_pb = 0;
+  top->i_serial_rx = 1;
+  top->i_serial_ndtr = 1;
+  top->i_uart_rx = 1;
+  top->eval();
+
+  const auto started = std::chrono::steady_clock::now();
+  const char *reason = "cycle limit reached";
+  int status = 2;
+  uint64_t cycle = 0;
+  uint64_t last_output = 0;
+  while (max_cycles == 0 || cycle < max_cycles) {
+    top->i_clk = 1;
+    top->eval();
+    top->i_clk = 0;
+    top->eval();
+    ++cycle;
+
+    if (cycle == RESET_CYCLES) {
+      top->i_rst = 0;
+    }
+    if (cycle < 2 * RESET_CYCLES) {
+      continue;
+    }
+    bool sent0, sent1;
+    top->i_serial_rx = uart0.tick(top->o_serial_tx, sent0);
+    top->i_uart_rx = uart1.tick(top->o_uart_tx, sent1);
+    if (sent0 || sent1) {
+      last_output = cycle;
+    }
+
+    if (top->o_trap) {
+      reason = "CPU trapped";
+      status = 1;
+      break;
+    }
+    if (top->o_halt) {
+      reason = "firmware halted";
+      status = 0;
+      break;
+    }
+    if (idle_cycles != 0 && cycle - last_output >= idle_cycles) {
+      reason = "UARTs idle";
+      status = 0;
+      break;
+    }
+    if ((cycle & 0xFFFFF) == 0) {
+      uart0.flush();
+      uart1.flush();
+      if (interrupted) {
+        reason = "interrupted";
+        status = 130;
+        break;
+      }
+    }
+  }
+  uart0.flush();
+  uart1.flush();
+  top->final();
+
+  if (!quiet) {
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - started)
+                               .count();
+    std::fprintf(stderr,
+                 "\nsim: %s after %llu cycles (%.3f ms), "
+                 "%.3f s host time, %.2f MHz\n",
+                 reason, (unsigned long long)cycle,
+                 cycle * 1e3 / CLK_FREQ_HZ, seconds, cycle / seconds / 1e6);
+  }
+  return status;
+}
@@ -0,0 +1,87 @@
+#include "uart.hpp"
+
+#include <cerrno>
+#include <unistd.h>
+
+UartPipe::UartPipe(const uint32_t clocks_per_bit, const int in_fd,
+                   const int out_fd)
+    : clocks_per_bit(clocks_per_bit), in_fd(in_fd), out_fd(out_fd) {}
+
+void UartPipe::poll_input(void) {
+  if (in_fd < 0) {
+    return;
+  }
+  uint8_t buffer[64];
+  const ssize_t length = read(in_fd, buffer, sizeof(buffer));
+  if (length > 0) {
+    pending.insert(pending.end(), buffer, buffer + length);
+  } else if (length == 0 || (errno != EAGAIN && errno != EINTR)) {
+    in_fd = -1;
+  }
+}
+
+void UartPipe::flush(void) {
+  uint32_t written = 0;
+  while (out_fd >= 0 && written < output_len) {
+    const ssize_t length =
+        write(out_fd, output + written, output_len - written);
+    if (length < 0 && errno != EINTR && errno != EAGAIN) {
+      out_fd = -1;
+    } else if (length > 0) {
+      written += length;
+    }
+  }
+  output_len = 0;
+}
+
+uint8_t UartPipe::tick(const uint8_t device_tx, bool &sent) {
+  sent = false;
+
+  if (rx_bits == 0) {
+    if (pending.empty() && poll_countdown-- == 0) {
+      poll_countdown = clocks_per_bit * 10;
+      poll_input();
+    }
+    if (!pending.empty()) {
+      rx_frame = 1 << 9 | pending.front() << 1;
+      rx_bits = 10;
+      rx_clocks = clocks_per_bit;
+      pending.pop_front();
+    }
+  }
+  const uint8_t device_rx = rx_bits ? rx_frame & 1 : 1;
+  if (rx_bits && --rx_clocks == 0) {
+    rx_frame >>= 1;
+    --rx_bits;
+    rx_clocks = clocks_per_bit;
+  }
+
+  if (!tx_busy) {
+    if (device_tx == 0) {
+      tx_busy = true;
+      tx_byte = 0;
+      tx_bit = 0;
+      tx_clocks = clocks_per_bit / 2;
+    }
+  } else if (--tx_clocks == 0) {
+    tx_clocks = clocks_per_bit;
+    if (tx_bit == 0) {
+      tx_busy = device_tx == 0;
+      tx_bit = 1;
+    } else if (tx_bit <= 8) {
+      tx_byte |= device_tx << (tx_bit - 1);
+      ++tx_bit;
+    } else {
+      tx_busy = false;
+      if (device_tx) {
+        output[output_len++] = tx_byte;
+        sent = true;
+        if (tx_byte == '\n' || output_len == sizeof(output)) {
+          flush();
+        }
+      }
+    }
+  }
+
+  return device_rx;
+}
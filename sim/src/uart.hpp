@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+/* Bit-level 8N1 serial line between a simulated UART and a pair of host
+ * file descriptors. Host input is read without blocking and shifted into
+ * the device one frame at a time, device output is sampled mid-bit. */
+class UartPipe {
+public:
+  UartPipe(const uint32_t clocks_per_bit, const int in_fd, const int out_fd);
+
+  /* Advances the line by one clock, returning the level for the device RX
+   * pin. Returns true in sent when a complete byte was written out. */
+  uint8_t tick(const uint8_t device_tx, bool &sent);
+  void flush(void);
+
+private:
+  void poll_input(void);
+
+  uint32_t clocks_per_bit;
+  int in_fd;
+  int out_fd;
+
+  std::deque<uint8_t> pending;
+  uint32_t poll_countdown = 0;
+
+  uint16_t rx_frame = 0;
+  uint32_t rx_bits = 0;
+  uint32_t rx_clocks = 0;
+
+  bool tx_busy = false;
+  uint8_t tx_byte = 0;
+  uint32_t tx_bit = 0;
+  uint32_t tx_clocks = 0;
+
+  uint8_t output[256];
+  uint32_t output_len = 0;
+};
@@ -0,0 +1,299 @@
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+use ieee.math_real.all;
+
+-- Drives the SDRAM cache through its arbiter port, which the CPU and the
+-- DMA controller share, in front of a pipelined memory that stalls every
+-- third cycle. Reads are compared with a shadow copy of the memory and the
+-- hit and miss counters with a reference model of the tags, first for
+-- fills, conflicts and write hits and misses, then for random accesses.
+
+entity Cache_TB is
+	generic (
+		g_RANDOM_ACCESSES : natural := 4000
+	);
+end Cache_TB;
+
+architecture Behavioral of Cache_TB is
+
+	constant c_CLK : time := 20 ns;
+	constant c_LINES : positive := 16;
+	constant c_LINE_WORDS : positive := 4;
+	constant c_LINE_BYTES : positive := c_LINE_WORDS * 4;
+	constant c_MEMORY_WORDS : positive := 1024;
+	constant c_LATENCY : positive := 3;
+
+	type t_memory is array(0 to c_MEMORY_WORDS - 1) of std_logic_vector(31 downto 0);
+
+	signal s_clk : std_logic := '0';
+	signal s_rst_n : std_logic := '0';
+	signal s_done : boolean := false;
+
+	signal s_wb_cyc : std_logic := '0';
+	signal s_wb_stb : std_logic := '0';
+	signal s_wb_we : std_logic := '0';
+	signal s_wb_addr : std_logic_vector(21 downto 0) := (others => '0');
+	signal s_wb_data_i : std_logic_vector(31 downto 0) := (others => '0');
+	signal s_wb_sel : std_logic_vector(3 downto 0) := (others => '0');
+	signal s_wb_stall : std_logic;
+	signal s_wb_ack : std_logic;
+	signal s_wb_data_o : std_logic_vector(31 downto 0);
+
+	signal s_sdram_cyc : std_logic;
+	signal s_sdram_stb : std_logic;
+	signal s_sdram_we : std_logic;
+	signal s_sdram_addr : std_logic_vector(21 downto 0);
+	signal s_sdram_data_i : std_logic_vector(31 downto 0);
+	signal s_sdram_sel : std_logic_vector(3 downto 0);
+	signal s_sdram_stall : std_logic := '0';
+	signal s_sdram_ack : std_logic := '0';
+	signal s_sdram_data_o : std_logic_vector(31 downto 0) := (others => '0');
+
+	signal s_hits : std_logic_vector(31 downto 0);
+	signal s_misses : std_logic_vector(31 downto 0);
+
+	function initial_word(index : natural) return std_logic_vector is
+	begin
+		return std_logic_vector(to_unsigned(index, 16)) & not std_logic_vector(to_unsigned(index, 16));
+	end function;
+
+	function merge(word, data, sel : std_logic_vector) return std_logic_vector is
+		variable v_word : std_logic_vector(31 downto 0) := word;
+	begin
+		for lane in 0 to 3 loop
+			if sel(lane) = '1' then
+				v_word(8 * lane + 7 downto 8 * lane) := data(8 * lane + 7 downto 8 * lane);
+			end if;
+		end loop;
+		return v_word;
+	end function;
+
+	function word_index(address : std_logic_vector) return natural is
+	begin
+		return to_integer(unsigned(address(21 downto 2))) mod c_MEMORY_WORDS;
+	end function;
+
+begin
+
+	s_clk <= not s_clk after c_CLK / 2 when not s_done else '0';
+	s_rst_n <= '1' after 5 * c_CLK;
+
+	dut : entity work.WB_SDRAM_Cache
+		generic map (
+			g_LINES => c_LINES,
+			g_LINE_WORDS => c_LINE_WORDS
+		)
+		port map (
+			clk => s_clk,
+			rst_n => s_rst_n,
+			i_wb_cyc => s_wb_cyc,
+			i_wb_stb => s_wb_stb,
+			i_wb_we => s_wb_we,
+			i_wb_addr => s_wb_addr,
+			i_wb_data => s_wb_data_i,
+			i_wb_sel => s_wb_sel,
+			o_wb_stall => s_wb_stall,
+			o_wb_ack => s_wb_ack,
+			o_wb_data => s_wb_data_o,
+			o_wb_sdram_cyc => s_sdram_cyc,
+			o_wb_sdram_stb => s_sdram_stb,
+			o_wb_sdram_we => s_sdram_we,
+			o_wb_sdram_addr => s_sdram_addr,
+			o_wb_sdram_data => s_sdram_data_i,
+			o_wb_sdram_sel => s_sdram_sel,
+			i_wb_sdram_stall => s_sdram_stall,
+			i_wb_sdram_ack => s_sdram_ack,
+			i_wb_sdram_data => s_sdram_data_o,
+			o_hits => s_hits,
+			o_misses => s_misses
+		);
+
+	------------
+	-- Memory --
+	------------
+
+	-- Requests are accepted unless stalled and acknowledged in order after
+	-- a fixed latency. Writes take effect when accepted.
+	sdram : process(s_clk)
+		variable v_memory : t_memory;
+		variable v_initialized : boolean := false;
+		variable v_valid : std_logic_vector(0 to c_LATENCY - 1) := (others => '0');
+		type t_pipeline is array(0 to c_LATENCY - 1) of natural;
+		variable v_index : t_pipeline := (others => 0);
+		variable v_cycle : natural := 0;
+	begin
+		if not v_initialized then
+			for i in 0 to c_MEMORY_WORDS - 1 loop
+				v_memory(i) := initial_word(i);
+			end loop;
+			v_initialized := true;
+		end if;
+		if rising_edge(s_clk) then
+			s_sdram_ack <= v_valid(c_LATENCY - 1);
+			s_sdram_data_o <= v_memory(v_index(c_LATENCY - 1));
+			v_valid := '0' & v_valid(0 to c_LATENCY - 2);
+			v_index := 0 & v_index(0 to c_LATENCY - 2);
+			if s_sdram_cyc = '1' and s_sdram_stb = '1' and s_sdram_stall = '0' then
+				v_valid(0) := '1';
+				v_index(0) := word_index(s_sdram_addr);
+				if s_sdram_we = '1' then
+					v_memory(v_index(0)) := merge(v_memory(v_index(0)), s_sdram_data_i, s_sdram_sel);
+				end if;
+			end if;
+			v_cycle := v_cycle + 1;
+			if v_cycle mod 3 = 2 then
+				s_sdram_stall <= '1';
+			else
+				s_sdram_stall <= '0';
+			end if;
+		end if;
+	end process;
+
+	-------------
+	-- Masters --
+	-------------
+
+	masters : process
+		variable v_shadow : t_memory;
+		type t_tags is array(0 to c_LINES - 1) of integer;
+		variable v_tags : t_tags := (others => -1);
+		variable v_hits : natural := 0;
+		variable v_misses : natural := 0;
+		variable v_seed1 : positive := 17;
+		variable v_seed2 : positive := 4711;
+
+		-- Holds the request until it is acknowledged, and checks the
+		-- counters once they have settled in the following cycle
+		procedure transfer(we : std_logic; address : natural;
+							  data : std_logic_vector(31 downto 0);
+							  sel : std_logic_vector(3 downto 0)) is
+			constant c_address : std_logic_vector(21 downto 0) := std_logic_vector(to_unsigned(address, 22));
+			constant c_index : natural := word_index(c_address);
+			constant c_line : natural := (address / c_LINE_BYTES) mod c_LINES;
+			constant c_tag : natural := address / (c_LINE_BYTES * c_LINES);
+			variable v_data : std_logic_vector(31 downto 0);
+		begin
+			s_wb_cyc <= '1';
+			s_wb_stb <= '1';
+			s_wb_we <= we;
+			s_wb_addr <= c_address;
+			s_wb_data_i <= data;
+			s_wb_sel <= sel;
+			loop
+				wait until rising_edge(s_clk);
+				exit when s_wb_ack = '1';
+			end loop;
+			v_data := s_wb_data_o;
+			s_wb_cyc <= '0';
+			s_wb_stb <= '0';
+			s_wb_we <= '0';
+
+			if we = '1' then
+				v_shadow(c_index) := merge(v_shadow(c_index), data, sel);
+			else
+				assert v_data = v_shadow(c_index)
+					report "read of " & integer'image(address) & " returned stale data"
+					severity failure;
+				if v_tags(c_line) = c_tag then
+					v_hits := v_hits + 1;
+				else
+					v_misses := v_misses + 1;
+					v_tags(c_line) := c_tag;
+				end if;
+			end if;
+
+			wait until rising_edge(s_clk);
+			assert unsigned(s_hits) = v_hits and unsigned(s_misses) = v_misses
+				report "counters at " & integer'image(to_integer(unsigned(s_hits))) & " hits and "
+					& integer'image(to_integer(unsigned(s_misses))) & " misses, expected "
+					& integer'image(v_hits) & " and " & integer'image(v_misses)
+				severity failure;
+		end procedure;
+
+		procedure cache_read(address : natural) is
+		begin
+			transfer('0', address, (others => '0'), "1111");
+		end procedure;
+
+		procedure cache_write(address : natural; data : std_logic_vector(31 downto 0);
+									sel : std_logic_vector(3 downto 0)) is
+		begin
+			transfer('1', address, data, sel);
+		end procedure;
+
+		variable v_random : real;
+		variable v_address : natural;
+		variable v_data : std_logic_vector(31 downto 0);
+		variable v_sel : std_logic_vector(3 downto 0);
+	begin
+		for i in 0 to c_MEMORY_WORDS - 1 loop
+			v_shadow(i) := initial_word(i);
+		end loop;
+		wait until s_rst_n = '1';
+
+		-- A miss fills the whole line, which then hits
+
+		cache_read(16#000#);
+		cache_read(16#004#);
+		cache_read(16#008#);
+		cache_read(16#00C#);
+		assert v_hits = 3 and v_misses = 1 report "fill not hit" severity failure;
+
+		-- Lines a cache size apart evict each other
+
+		cache_read(16#100#);
+		cache_read(16#000#);
+		assert v_misses = 3 report "conflict not missed" severity failure;
+
+		-- Write hits update the cached line, including partial writes
+
+		cache_write(16#004#, x"DEADBEEF", "1111");
+		cache_write(16#008#, x"0000AB00", "0010");
+		cache_read(16#004#);
+		cache_read(16#008#);
+
+		-- Write misses do not allocate, but reach the memory for the next fill
+
+		cache_write(16#204#, x"12345678", "1111");
+		cache_read(16#00C#);
+		cache_read(16#204#);
+		cache_read(16#004#);
+
+		-- Writes of the DMA controller to a cached line keep it coherent
+
+		cache_read(16#030#);
+		for i in 0 to c_LINE_WORDS - 1 loop
+			cache_write(16#030# + 4 * i, std_logic_vector(to_unsigned(i * 16#01010101#, 32)), "1111");
+		end loop;
+		for i in 0 to c_LINE_WORDS - 1 loop
+			cache_read(16#030# + 4 * i);
+		end loop;
+
+		report "directed accesses passed, " & integer'image(v_hits) & " hits and "
+			& integer'image(v_misses) & " misses";
+
+		-- Random reads and writes over four times the cache size
+
+		for i in 1 to g_RANDOM_ACCESSES loop
+			uniform(v_seed1, v_seed2, v_random);
+			v_address := natural(floor(v_random * real(4 * c_LINES * c_LINE_WORDS))) * 4;
+			uniform(v_seed1, v_seed2, v_random);
+			if v_random < 0.3 then
+				uniform(v_seed1, v_seed2, v_random);
+				v_data := std_logic_vector(to_unsigned(natural(floor(v_random * 65536.0)), 16))
+					& std_logic_vector(to_unsigned(i mod 65536, 16));
+				uniform(v_seed1, v_seed2, v_random);
+				v_sel := std_logic_vector(to_unsigned(1 + natural(floor(v_random * 15.0)), 4));
+				cache_write(v_address, v_data, v_sel);
+			else
+				cache_read(v_address);
+			end if;
+		end loop;
+
+		report "passed, " & integer'image(v_hits) & " hits and " & integer'image(v_misses) & " misses";
+		s_done <= true;
+		wait;
+	end process;
+
+end Behavioral;
@@ -0,0 +1,291 @@
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+-- Streams back-to-back frames into the buffered UART at 2 Mbaud. The first
+-- burst is not read until it overflows the receive FIFO. The second one is
+-- read by a consumer which waits for each threshold IRQ and drains the FIFO
+-- after the given latency, as the firmware does, and reads the tail below
+-- the threshold on the idle IRQ. The transmit FIFO is filled and emptied
+-- meanwhile.
+
+entity UART_TB is
+	generic (
+		g_LATENCY_CLKS : natural := 1700 -- just under 7 frames
+	);
+end UART_TB;
+
+architecture Behavioral of UART_TB is
+
+	constant c_CLK : time := 20 ns;
+	constant c_CLKS_PER_BIT : positive := 25;
+	constant c_BIT : time := c_CLK * c_CLKS_PER_BIT;
+	constant c_FIFO_DEPTH : positive := 16;
+	constant c_BURST_A : positive := c_FIFO_DEPTH + 1;
+	constant c_BURST_B : positive := 64;
+	constant c_RX_IDLE : time := 4 * 10 * c_BIT;
+
+	signal s_clk : std_logic := '0';
+	signal s_rst_n : std_logic := '0';
+	signal s_done : boolean := false;
+
+	signal s_rx : std_logic := '1';
+	signal s_tx : std_logic;
+
+	signal s_tx_push : std_logic := '0';
+	signal s_tx_data : std_logic_vector(7 downto 0) := (others => '0');
+	signal s_tx_ready : std_logic;
+	signal s_tx_level : std_logic_vector(4 downto 0);
+	signal s_tx_done : std_logic;
+	signal s_tx_threshold : std_logic;
+
+	signal s_rx_pop : std_logic := '0';
+	signal s_rx_data : std_logic_vector(7 downto 0);
+	signal s_rx_ready : std_logic;
+	signal s_rx_level : std_logic_vector(4 downto 0);
+	signal s_rx_dv : std_logic;
+	signal s_rx_threshold : std_logic;
+	signal s_rx_idle : std_logic;
+	signal s_rx_overrun_clr : std_logic := '0';
+	signal s_rx_overrun : std_logic;
+
+	signal s_burst_a_sent : boolean := false;
+	signal s_burst_b_start : boolean := false;
+	signal s_burst_b_sent : boolean := false;
+	signal s_tx_checked : boolean := false;
+
+	signal s_rx_thresholds : natural := 0;
+	signal s_rx_idles : natural := 0;
+
+	function frame_byte(index : natural) return std_logic_vector is
+	begin
+		return std_logic_vector(to_unsigned((index * 37 + 11) mod 256, 8));
+	end function;
+
+begin
+
+	s_clk <= not s_clk after c_CLK / 2 when not s_done else '0';
+	s_rst_n <= '1' after 5 * c_CLK;
+
+	dut : entity work.UART_Buffered
+		generic map (
+			g_CLKS_PER_BIT => c_CLKS_PER_BIT,
+			g_FIFO_DEPTH => c_FIFO_DEPTH
+		)
+		port map (
+			clk => s_clk,
+			rst_n => s_rst_n,
+			i_rx => s_rx,
+			o_tx => s_tx,
+			i_tx_push => s_tx_push,
+			i_tx_data => s_tx_data,
+			o_tx_ready => s_tx_ready,
+			o_tx_level => s_tx_level,
+			o_tx_done => s_tx_done,
+			o_tx_threshold => s_tx_threshold,
+			i_rx_pop => s_rx_pop,
+			o_rx_data => s_rx_data,
+			o_rx_ready => s_rx_ready,
+			o_rx_level => s_rx_level,
+			o_rx_dv => s_rx_dv,
+			o_rx_threshold => s_rx_threshold,
+			o_rx_idle => s_rx_idle,
+			i_rx_overrun_clr => s_rx_overrun_clr,
+			o_rx_overrun => s_rx_overrun
+		);
+
+	------------
+	-- Sender --
+	------------
+
+	sender : process
+		procedure send(data : std_logic_vector(7 downto 0)) is
+		begin
+			s_rx <= '0';
+			wait for c_BIT;
+			for i in 0 to 7 loop
+				s_rx <= data(i);
+				wait for c_BIT;
+			end loop;
+			s_rx <= '1';
+			wait for c_BIT;
+		end procedure;
+	begin
+		wait until s_rst_n = '1';
+		wait for 10 * c_CLK;
+		for i in 0 to c_BURST_A - 1 loop
+			send(frame_byte(i));
+		end loop;
+		s_burst_a_sent <= true;
+		wait until s_burst_b_start;
+		for i in c_BURST_A to c_BURST_A + c_BURST_B - 1 loop
+			send(frame_byte(i));
+		end loop;
+		s_burst_b_sent <= true;
+		wait;
+	end process;
+
+	thresholds : process(s_clk)
+	begin
+		if rising_edge(s_clk) and s_rx_threshold = '1' then
+			s_rx_thresholds <= s_rx_thresholds + 1;
+		end if;
+		if rising_edge(s_clk) and s_rx_idle = '1' then
+			s_rx_idles <= s_rx_idles + 1;
+		end if;
+	end process;
+
+	--------------
+	-- Receiver --
+	--------------
+
+	receiver : process
+		variable v_expected : natural := 0;
+		variable v_level_max : natural := 0;
+		variable v_drains : natural := 0;
+
+		-- Pops on every other cycle, so the level has settled before each read
+		procedure drain is
+		begin
+			while s_rx_ready = '1' loop
+				assert s_rx_data = frame_byte(v_expected)
+					report "byte " & integer'image(v_expected) & " received out of order"
+					severity failure;
+				v_expected := v_expected + 1;
+				s_rx_pop <= '1';
+				wait until rising_edge(s_clk);
+				s_rx_pop <= '0';
+				wait until rising_edge(s_clk);
+			end loop;
+		end procedure;
+	begin
+		wait until s_rst_n = '1';
+
+		-- Burst A fills the FIFO without an overrun, and the byte after it
+		-- is dropped and flagged
+
+		wait until rising_edge(s_clk) and unsigned(s_rx_level) = c_FIFO_DEPTH;
+		assert s_rx_overrun = '0'
+			report "overrun flagged before the FIFO was full" severity failure;
+		assert s_rx_thresholds = 1
+			report "threshold IRQ not raised once while filling" severity failure;
+		wait until s_burst_a_sent;
+		wait until rising_edge(s_clk);
+		assert s_rx_overrun = '1'
+			report "overrun not flagged" severity failure;
+		assert unsigned(s_rx_level) = c_FIFO_DEPTH
+			report "level changed by a dropped byte" severity failure;
+
+		drain;
+		assert v_expected = c_FIFO_DEPTH
+			report "drained " & integer'image(v_expected) & " bytes" severity failure;
+		assert unsigned(s_rx_level) = 0
+			report "level not zero after draining" severity failure;
+		assert s_rx_thresholds = 1
+			report "threshold IRQ raised while draining" severity failure;
+
+		s_rx_overrun_clr <= '1';
+		wait until rising_edge(s_clk);
+		s_rx_overrun_clr <= '0';
+		wait until rising_edge(s_clk);
+		assert s_rx_overrun = '0'
+			report "overrun not cleared" severity failure;
+
+		-- The FIFO was drained before the line became idle
+
+		wait for c_RX_IDLE + c_BIT;
+		assert s_rx_idles = 0
+			report "idle IRQ raised with an empty FIFO" severity failure;
+
+		-- Burst B is drained after each threshold IRQ with a latency, which
+		-- the FIFO has to absorb at the full line rate, and its tail below
+		-- the threshold on the idle IRQ
+
+		v_expected := c_BURST_A;
+		s_burst_b_start <= true;
+		while v_expected < c_BURST_A + c_BURST_B loop
+			wait until rising_edge(s_clk) and (s_rx_threshold = '1' or s_rx_idle = '1')
+				for 2 * c_RX_IDLE;
+			assert s_rx_threshold = '1' or s_rx_idle = '1'
+				report "no receive IRQ with " & integer'image(to_integer(unsigned(s_rx_level)))
+					& " bytes in the FIFO" severity failure;
+			if s_rx_threshold = '1' then
+				wait for g_LATENCY_CLKS * c_CLK;
+				wait until rising_edge(s_clk);
+				v_drains := v_drains + 1;
+			else
+				assert s_burst_b_sent
+					report "idle IRQ raised during the burst" severity failure;
+			end if;
+			if to_integer(unsigned(s_rx_level)) > v_level_max then
+				v_level_max := to_integer(unsigned(s_rx_level));
+			end if;
+			drain;
+		end loop;
+
+		assert v_expected = c_BURST_A + c_BURST_B
+			report "received " & integer'image(v_expected - c_BURST_A) & " of "
+				& integer'image(c_BURST_B) & " bytes" severity failure;
+		assert s_rx_overrun = '0'
+			report "overrun with a latency of " & integer'image(g_LATENCY_CLKS)
+				& " cycles" severity failure;
+		assert v_drains = s_rx_thresholds - 1
+			report "drains do not match threshold IRQs" severity failure;
+		assert s_rx_idles = 1
+			report "idle IRQ raised " & integer'image(s_rx_idles) & " times"
+			severity failure;
+		report "receive passed, " & integer'image(v_drains) & " drains at level "
+			& integer'image(v_level_max) & " at most";
+
+		wait until s_tx_checked;
+		report "passed";
+		s_done <= true;
+		wait;
+	end process;
+
+	--------------
+	-- Transmit --
+	--------------
+
+	transmitter : process
+		variable v_pushed : natural := 0;
+		variable v_tx_thresholds : natural := 0;
+	begin
+		wait until s_rst_n = '1';
+		wait until rising_edge(s_clk);
+
+		-- Fill until full, while the first byte already moves to the shifter
+
+		while s_tx_ready = '1' loop
+			s_tx_push <= '1';
+			s_tx_data <= frame_byte(v_pushed);
+			v_pushed := v_pushed + 1;
+			wait until rising_edge(s_clk);
+			s_tx_push <= '0';
+			wait until rising_edge(s_clk);
+		end loop;
+		assert unsigned(s_tx_level) = c_FIFO_DEPTH
+			report "transmit FIFO not full" severity failure;
+		assert v_pushed = c_FIFO_DEPTH + 1
+			report "pushed " & integer'image(v_pushed) & " bytes until full"
+			severity failure;
+
+		-- The low threshold IRQ fires once, when a quarter is left
+
+		while unsigned(s_tx_level) /= 0 loop
+			wait until rising_edge(s_clk);
+			if s_tx_threshold = '1' then
+				v_tx_thresholds := v_tx_thresholds + 1;
+				assert unsigned(s_tx_level) = c_FIFO_DEPTH / 4
+					report "threshold IRQ at level " & integer'image(to_integer(unsigned(s_tx_level)))
+					severity failure;
+			end if;
+		end loop;
+		assert v_tx_thresholds = 1
+			report "threshold IRQ raised " & integer'image(v_tx_thresholds) & " times"
+			severity failure;
+		s_tx_checked <= true;
+		wait;
+	end process;
+
+end Behavioral;